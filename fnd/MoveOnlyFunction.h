@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace HomeCompa
+{
+
+/// Move-only replacement of std::function with inline storage for small callables.
+/// Callables up to InlineSize bytes are stored without heap allocation, move-only captures (std::unique_ptr etc.) are allowed.
+template <typename Signature, size_t InlineSize = 64>
+class MoveOnlyFunction;
+
+template <typename R, typename... Args, size_t InlineSize>
+class MoveOnlyFunction<R(Args...), InlineSize>
+{
+	struct VTable
+	{
+		R (*invoke)(void* storage, Args&&... args);
+		void (*move)(void* dst, void* src) noexcept;
+		void (*destroy)(void* storage) noexcept;
+	};
+
+	template <typename F>
+	static constexpr bool IS_INLINE = sizeof(F) <= InlineSize && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+
+	template <typename F>
+	static F& Get(void* storage) noexcept
+	{
+		if constexpr (IS_INLINE<F>)
+			return *std::launder(static_cast<F*>(storage));
+		else
+			return **static_cast<F**>(storage);
+	}
+
+	template <typename F>
+	static constexpr VTable VTABLE {
+		[](void* storage, Args&&... args) -> R {
+			return std::invoke(Get<F>(storage), std::forward<Args>(args)...);
+		},
+		[](void* dst, void* src) noexcept {
+			if constexpr (IS_INLINE<F>)
+			{
+				::new (dst) F(std::move(Get<F>(src)));
+				Get<F>(src).~F();
+			}
+			else
+			{
+				*static_cast<F**>(dst) = std::exchange(*static_cast<F**>(src), nullptr);
+			}
+		},
+		[](void* storage) noexcept {
+			if constexpr (IS_INLINE<F>)
+				Get<F>(storage).~F();
+			else
+				delete *static_cast<F**>(storage);
+		},
+	};
+
+public:
+	MoveOnlyFunction() noexcept = default;
+
+	MoveOnlyFunction(std::nullptr_t) noexcept // NOLINT(google-explicit-constructor)
+	{
+	}
+
+	template <typename F, typename D = std::decay_t<F>>
+		requires(!std::is_same_v<D, MoveOnlyFunction> && std::is_invocable_r_v<R, D&, Args...>)
+	MoveOnlyFunction(F&& f) // NOLINT(google-explicit-constructor)
+	{
+		if constexpr (std::is_pointer_v<D> || std::is_member_pointer_v<D> || requires { static_cast<bool>(f); })
+			if (!static_cast<bool>(f))
+				return;
+
+		if constexpr (IS_INLINE<D>)
+			::new (static_cast<void*>(m_storage)) D(std::forward<F>(f));
+		else
+			::new (static_cast<void*>(m_storage)) D*(new D(std::forward<F>(f)));
+
+		m_vtable = &VTABLE<D>;
+	}
+
+	MoveOnlyFunction(MoveOnlyFunction&& rhs) noexcept
+		: m_vtable { std::exchange(rhs.m_vtable, nullptr) }
+	{
+		if (m_vtable)
+			m_vtable->move(m_storage, rhs.m_storage);
+	}
+
+	MoveOnlyFunction& operator=(MoveOnlyFunction&& rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			reset();
+			if ((m_vtable = std::exchange(rhs.m_vtable, nullptr)))
+				m_vtable->move(m_storage, rhs.m_storage);
+		}
+		return *this;
+	}
+
+	MoveOnlyFunction& operator=(std::nullptr_t) noexcept
+	{
+		reset();
+		return *this;
+	}
+
+	MoveOnlyFunction(const MoveOnlyFunction&)            = delete;
+	MoveOnlyFunction& operator=(const MoveOnlyFunction&) = delete;
+
+	~MoveOnlyFunction()
+	{
+		reset();
+	}
+
+	R operator()(Args... args) const
+	{
+		assert(m_vtable);
+		return m_vtable->invoke(m_storage, std::forward<Args>(args)...);
+	}
+
+	explicit operator bool() const noexcept
+	{
+		return !!m_vtable;
+	}
+
+	bool operator==(std::nullptr_t) const noexcept
+	{
+		return !m_vtable;
+	}
+
+private:
+	void reset() noexcept
+	{
+		if (m_vtable)
+			std::exchange(m_vtable, nullptr)->destroy(m_storage);
+	}
+
+private:
+	const VTable*                               m_vtable { nullptr };
+	alignas(std::max_align_t) mutable std::byte m_storage[InlineSize];
+};
+
+} // namespace HomeCompa
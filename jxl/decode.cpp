@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <QImage>
 
 #include <jxl/decode.h>
@@ -11,26 +13,72 @@
 namespace HomeCompa::JXL
 {
 
+namespace
+{
+
+/// keeps every reduction-th pixel of every reduction-th row: the full resolution buffer is never allocated
+struct DecimatingOutput
+{
+	uint8_t* bits;
+	size_t   bytesPerLine;
+	size_t   reduction;
+	size_t   pixelSize;
+
+	static void Write(void* opaque, const size_t x, const size_t y, const size_t numPixels, const void* pixels)
+	{
+		const auto& self = *static_cast<const DecimatingOutput*>(opaque);
+		if (y % self.reduction)
+			return;
+
+		auto*       dst = self.bits + y / self.reduction * self.bytesPerLine;
+		const auto* src = static_cast<const uint8_t*>(pixels);
+		for (auto i = (self.reduction - x % self.reduction) % self.reduction; i < numPixels; i += self.reduction)
+			std::copy_n(src + i * self.pixelSize, self.pixelSize, dst + (x + i) / self.reduction * self.pixelSize);
+	}
+};
+
+size_t GetReduction(const JxlBasicInfo& info, const int minSize)
+{
+	size_t reduction = 1;
+	while (minSize > 0 && std::min(info.xsize, info.ysize) / (reduction * 2) >= static_cast<size_t>(minSize))
+		reduction *= 2;
+	return reduction;
+}
+
+} // namespace
+
 QImage Decode(const QByteArray& bytes)
+{
+	return Decode(bytes, 0);
+}
+
+QImage Decode(const QByteArray& bytes, const int minSize)
 {
 	QImage     image;
 	const auto runner = JxlResizableParallelRunnerMake(nullptr);
 
 	const auto dec = JxlDecoderMake(nullptr);
-	if (JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_BASIC_INFO | JXL_DEC_FULL_IMAGE))
+	if (JXL_DEC_SUCCESS != JxlDecoderSubscribeEvents(dec.get(), JXL_DEC_BASIC_INFO | JXL_DEC_FULL_IMAGE | (minSize > 0 ? JXL_DEC_FRAME_PROGRESSION : 0)))
 	{
 		PLOGE << "JxlDecoderSubscribeEvents failed";
 		return {};
 	}
 
+	if (minSize > 0 && JXL_DEC_SUCCESS != JxlDecoderSetProgressiveDetail(dec.get(), kDC))
+	{
+		PLOGE << "JxlDecoderSetProgressiveDetail failed";
+		return {};
+	}
+
 	if (JXL_DEC_SUCCESS != JxlDecoderSetParallelRunner(dec.get(), JxlResizableParallelRunner, runner.get()))
 	{
 		PLOGE << "JxlDecoderSetParallelRunner failed";
 		return {};
 	}
 
-	JxlBasicInfo   info;
-	JxlPixelFormat format;
+	JxlBasicInfo     info;
+	JxlPixelFormat   format;
+	DecimatingOutput output { nullptr, 0, 1, 0 };
 
 	JxlDecoderSetInput(dec.get(), reinterpret_cast<const uint8_t*>(bytes.constData()), static_cast<size_t>(bytes.size()));
 	JxlDecoderCloseInput(dec.get());
@@ -54,14 +102,29 @@ QImage Decode(const QByteArray& bytes)
 					return {};
 				}
 
-				image  = QImage(static_cast<int>(info.xsize), static_cast<int>(info.ysize), info.num_extra_channels ? QImage::Format_RGBA8888 : QImage::Format_RGB888);
-				format = JxlPixelFormat { image.pixelFormat().channelCount(), JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, static_cast<size_t>(image.bytesPerLine()) };
+				output.reduction = GetReduction(info, minSize);
+				image            = QImage(static_cast<int>((info.xsize + output.reduction - 1) / output.reduction), static_cast<int>((info.ysize + output.reduction - 1) / output.reduction), info.num_extra_channels ? QImage::Format_RGBA8888 : QImage::Format_RGB888);
+				format           = JxlPixelFormat { image.pixelFormat().channelCount(), JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, output.reduction > 1 ? 0 : static_cast<size_t>(image.bytesPerLine()) };
+
+				output.bits         = image.bits();
+				output.bytesPerLine = static_cast<size_t>(image.bytesPerLine());
+				output.pixelSize    = image.pixelFormat().channelCount();
 
 				JxlResizableParallelRunnerSetThreads(runner.get(), JxlResizableParallelRunnerSuggestThreads(info.xsize, info.ysize));
 				break;
 
 			case JXL_DEC_NEED_IMAGE_OUT_BUFFER:
 			{
+				if (output.reduction > 1)
+				{
+					if (JXL_DEC_SUCCESS != JxlDecoderSetImageOutCallback(dec.get(), &format, &DecimatingOutput::Write, &output))
+					{
+						PLOGE << "JxlDecoderSetImageOutCallback failed";
+						return {};
+					}
+					break;
+				}
+
 				const auto imageDataSize = static_cast<size_t>(image.height() * image.bytesPerLine());
 				size_t     bufferSize;
 				if (JXL_DEC_SUCCESS != JxlDecoderImageOutBufferSize(dec.get(), &format, &bufferSize))
@@ -83,6 +146,21 @@ QImage Decode(const QByteArray& bytes)
 				break;
 			}
 
+			case JXL_DEC_FRAME_PROGRESSION:
+			{
+				// the passes decoded so far are detailed enough: the rest of the codestream is skipped
+				const auto ratio = JxlDecoderGetIntendedDownsamplingRatio(dec.get());
+				if (std::min(info.xsize, info.ysize) / ratio < static_cast<size_t>(minSize))
+					break;
+
+				if (JXL_DEC_SUCCESS != JxlDecoderFlushImage(dec.get()))
+				{
+					PLOGE << "JxlDecoderFlushImage failed";
+					return {};
+				}
+				return image;
+			}
+
 			case JXL_DEC_FULL_IMAGE:
 				break;
 
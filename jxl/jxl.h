@@ -13,4 +13,8 @@ constexpr auto          FORMAT = "jxl";
 FLJXL_EXPORT QByteArray Encode(const QImage& image, int quality);
 FLJXL_EXPORT QImage     Decode(const QByteArray& bytes);
 
+/// the image is decimated by a power of two while its shorter side stays not less than minSize,
+/// the decoding stops after the first progressive pass detailed enough for that size
+FLJXL_EXPORT QImage Decode(const QByteArray& bytes, int minSize);
+
 }
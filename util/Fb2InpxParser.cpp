@@ -23,6 +23,7 @@ namespace
 
 constexpr auto NAME                   = "name";
 constexpr auto NUMBER                 = "number";
+constexpr auto DESCRIPTION            = "FictionBook/description";
 constexpr auto GENRE                  = "FictionBook/description/title-info/genre";
 constexpr auto AUTHOR                 = "FictionBook/description/title-info/author";
 constexpr auto AUTHOR_FIRST_NAME      = "FictionBook/description/title-info/author/first-name";
@@ -82,10 +83,15 @@ QString GenresToString(const QStringList& genres)
 
 class Fb2InpxParserImpl final : public SaxParser
 {
+	using ParseElementFunction   = bool (Fb2InpxParserImpl::*)(const XmlAttributes&);
+	using EndElementFunction     = bool (Fb2InpxParserImpl::*)();
+	using ParseCharacterFunction = bool (Fb2InpxParserImpl::*)(const QString&);
+
 public:
-	Fb2InpxParserImpl(QIODevice& stream, const QString& fileName)
+	Fb2InpxParserImpl(QIODevice& stream, const QString& fileName, const Mode mode)
 		: SaxParser(stream, 512)
 		, m_fileName(fileName)
+		, m_mode(mode)
 	{
 	}
 
@@ -99,56 +105,24 @@ public:
 	}
 
 private: // SaxParser
-	bool OnStartElement(const QString& /*name*/, const QString& path, const XmlAttributes& attributes) override
+	bool OnStartElementId(QStringView /*name*/, const PathId path, const XmlAttributes& attributes) override
 	{
-		using ParseElementFunction = bool (Fb2InpxParserImpl::*)(const XmlAttributes&);
-		using ParseElementItem     = std::pair<const char*, ParseElementFunction>;
-		static constexpr ParseElementItem PARSERS[] {
-			{     AUTHOR,     &Fb2InpxParserImpl::OnStartElementAuthor },
-			{ AUTHOR_DOC,  &Fb2InpxParserImpl::OnStartElementAuthorDoc },
-			{   SEQUENCE,   &Fb2InpxParserImpl::OnStartElementSequence },
-			{ ANNOTATION, &Fb2InpxParserImpl::OnStartElementAnnotation },
-		};
-
-		return Parse(*this, PARSERS, path, attributes);
+		return Parse(*this, m_startElementParsers, path, attributes);
 	}
 
-	bool OnEndElement(const QString& /*name*/, const QString& path) override
+	bool OnEndElementId(QStringView /*name*/, const PathId path) override
 	{
-		using ParseElementFunction = bool (Fb2InpxParserImpl::*)();
-		using ParseElementItem     = std::pair<const char*, ParseElementFunction>;
-		static constexpr ParseElementItem PARSERS[] {
-			{     AUTHOR,     &Fb2InpxParserImpl::OnEndElementAuthor },
-			{ AUTHOR_DOC,     &Fb2InpxParserImpl::OnEndElementAuthor },
-			{ ANNOTATION, &Fb2InpxParserImpl::OnEndElementAnnotation },
-		};
-
-		return Parse(*this, PARSERS, path);
+		return Parse(*this, m_endElementParsers, path);
 	}
 
-	bool OnCharacters(const QString& path, const QString& value) override
+	bool OnCharactersId(const PathId path, const QStringView value) override
 	{
-		using ParseCharacterFunction = bool (Fb2InpxParserImpl::*)(const QString&);
-		using ParseCharacterItem     = std::pair<const char*, ParseCharacterFunction>;
-		static constexpr ParseCharacterItem PARSERS[] {
-			{				  GENRE,            &Fb2InpxParserImpl::ParseGenre },
-			{      AUTHOR_FIRST_NAME,  &Fb2InpxParserImpl::ParseAuthorFirstName },
-			{       AUTHOR_LAST_NAME,   &Fb2InpxParserImpl::ParseAuthorLastName },
-			{     AUTHOR_MIDDLE_NAME, &Fb2InpxParserImpl::ParseAuthorMiddleName },
-			{  AUTHOR_FIRST_NAME_DOC,  &Fb2InpxParserImpl::ParseAuthorFirstName },
-			{   AUTHOR_LAST_NAME_DOC,   &Fb2InpxParserImpl::ParseAuthorLastName },
-			{ AUTHOR_MIDDLE_NAME_DOC, &Fb2InpxParserImpl::ParseAuthorMiddleName },
-			{             BOOK_TITLE,        &Fb2InpxParserImpl::ParseBookTitle },
-			{				   LANG,             &Fb2InpxParserImpl::ParseLang },
-			{			   KEYWORDS,         &Fb2InpxParserImpl::ParseKeywords },
-			{      PUBLISH_INFO_YEAR,      &Fb2InpxParserImpl::ParsePublishYear },
-		};
-
 		if (m_annotationMode)
-			m_data.annotation << value.trimmed();
+			m_data.annotation << value.trimmed().toString();
 
+		if (m_mode == Mode::Full)
 		{
-			auto valueCopy = value;
+			auto valueCopy = value.toString();
 			PrepareTitle(valueCopy);
 			RemoveIf(valueCopy, [](const QChar ch) {
 				const auto category = ch.category();
@@ -157,7 +131,7 @@ private: // SaxParser
 			m_data.size += valueCopy.length();
 		}
 
-		return Parse(*this, PARSERS, path, value.trimmed());
+		return Parse(*this, m_characterParsers, path, value.trimmed().toString());
 	}
 
 	bool OnWarning(const size_t line, const size_t column, const QString& text) override
@@ -224,6 +198,11 @@ private:
 		return true;
 	}
 
+	bool OnEndElementDescription()
+	{
+		return m_mode != Mode::HeaderOnly;
+	}
+
 	bool ParseGenre(const QString& value)
 	{
 		ParseGenresString(m_data.genres, value);
@@ -277,9 +256,38 @@ private:
 
 private:
 	const QString& m_fileName;
+	const Mode     m_mode;
 	Data           m_data {};
 	bool           m_insertAuthorMode { false };
 	bool           m_annotationMode { false };
+
+	const std::vector<ParseElementFunction> m_startElementParsers { RegisterPaths<ParseElementFunction>({
+		{     AUTHOR,     &Fb2InpxParserImpl::OnStartElementAuthor },
+		{ AUTHOR_DOC,  &Fb2InpxParserImpl::OnStartElementAuthorDoc },
+		{   SEQUENCE,   &Fb2InpxParserImpl::OnStartElementSequence },
+		{ ANNOTATION, &Fb2InpxParserImpl::OnStartElementAnnotation },
+	}) };
+
+	const std::vector<EndElementFunction> m_endElementParsers { RegisterPaths<EndElementFunction>({
+		{      AUTHOR,      &Fb2InpxParserImpl::OnEndElementAuthor },
+		{  AUTHOR_DOC,      &Fb2InpxParserImpl::OnEndElementAuthor },
+		{  ANNOTATION,  &Fb2InpxParserImpl::OnEndElementAnnotation },
+		{ DESCRIPTION, &Fb2InpxParserImpl::OnEndElementDescription },
+	}) };
+
+	const std::vector<ParseCharacterFunction> m_characterParsers { RegisterPaths<ParseCharacterFunction>({
+		{				  GENRE,            &Fb2InpxParserImpl::ParseGenre },
+		{      AUTHOR_FIRST_NAME,  &Fb2InpxParserImpl::ParseAuthorFirstName },
+		{       AUTHOR_LAST_NAME,   &Fb2InpxParserImpl::ParseAuthorLastName },
+		{     AUTHOR_MIDDLE_NAME, &Fb2InpxParserImpl::ParseAuthorMiddleName },
+		{  AUTHOR_FIRST_NAME_DOC,  &Fb2InpxParserImpl::ParseAuthorFirstName },
+		{   AUTHOR_LAST_NAME_DOC,   &Fb2InpxParserImpl::ParseAuthorLastName },
+		{ AUTHOR_MIDDLE_NAME_DOC, &Fb2InpxParserImpl::ParseAuthorMiddleName },
+		{             BOOK_TITLE,        &Fb2InpxParserImpl::ParseBookTitle },
+		{				   LANG,             &Fb2InpxParserImpl::ParseLang },
+		{			   KEYWORDS,         &Fb2InpxParserImpl::ParseKeywords },
+		{      PUBLISH_INFO_YEAR,      &Fb2InpxParserImpl::ParsePublishYear },
+	}) };
 };
 
 } // namespace
@@ -287,14 +295,16 @@ private:
 namespace HomeCompa::Util::Fb2InpxParser
 {
 
-ParseResult Parse(const QString& folder, const Zip& zip, const QString& fileName, const QDateTime& zipDateTime, const bool isDeleted)
+ParseResult Parse(const QString& folder, const Zip& zip, const QString& fileName, const QDateTime& zipDateTime, const bool isDeleted, const Mode mode)
 {
 	try
 	{
 		QFileInfo         fileInfo(fileName);
 		const auto        stream = zip.Read(fileName);
-		Fb2InpxParserImpl parser(stream->GetStream(), fileName);
+		Fb2InpxParserImpl parser(stream->GetStream(), fileName, mode);
 		auto              parserData = parser.GetData();
+		if (mode == Mode::HeaderOnly)
+			parserData.size = zip.GetFileSize(fileName);
 
 		if (!parserData.error.isEmpty())
 		{
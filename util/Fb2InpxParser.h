@@ -19,13 +19,19 @@ namespace HomeCompa::Util::Fb2InpxParser
 static constexpr char NAMES_SEPARATOR  = ',';
 static constexpr char FIELDS_SEPARATOR = '\x04';
 
+enum class Mode
+{
+	Full,       // the whole book is parsed, the size is the letter count of its text
+	HeaderOnly, // parsing stops after the description, the size is the uncompressed file size
+};
+
 struct ParseResult
 {
 	QString     line;
 	QStringList annotation;
 };
 
-UTIL_EXPORT ParseResult Parse(const QString& folder, const Zip& zip, const QString& fileName, const QDateTime& zipDateTime, bool isDeleted);
+UTIL_EXPORT ParseResult Parse(const QString& folder, const Zip& zip, const QString& fileName, const QDateTime& zipDateTime, bool isDeleted, Mode mode = Mode::Full);
 UTIL_EXPORT QString     GetSeqNumber(QString seqNumber);
 
 } // namespace HomeCompa::Util::Fb2InpxParser
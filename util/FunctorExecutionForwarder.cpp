@@ -5,22 +5,19 @@
 namespace HomeCompa::Util
 {
 
-FunctorExecutionForwarder::FunctorExecutionForwarder()
-{
-	qRegisterMetaType<FunctorType>("FunctorType");
-
-	[[maybe_unused]] const bool result = connect(this, &FunctorExecutionForwarder::ExecuteFunctor, this, &FunctorExecutionForwarder::OnExecuteFunctor, Qt::QueuedConnection);
-	assert(result);
-}
+FunctorExecutionForwarder::FunctorExecutionForwarder() = default;
 
 void FunctorExecutionForwarder::Forward(FunctorType f) const
 {
-	emit ExecuteFunctor(std::move(f));
-}
-
-void FunctorExecutionForwarder::OnExecuteFunctor(FunctorType f) const
-{
-	f();
+	// the functor is moved into the queued call, a signal argument would have to be copyable
+	[[maybe_unused]] const bool result = QMetaObject::invokeMethod(
+		const_cast<FunctorExecutionForwarder*>(this),
+		[f = std::move(f)] {
+			f();
+		},
+		Qt::QueuedConnection
+	);
+	assert(result);
 }
 
 }
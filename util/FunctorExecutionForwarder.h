@@ -1,9 +1,9 @@
 #pragma once
 
-#include <functional>
-
 #include <QObject>
 
+#include "fnd/MoveOnlyFunction.h"
+
 #include "export/util.h"
 
 namespace HomeCompa::Util
@@ -14,15 +14,9 @@ class UTIL_EXPORT FunctorExecutionForwarder : public QObject
 	Q_OBJECT
 
 public:
-	using FunctorType = std::function<void()>;
+	using FunctorType = MoveOnlyFunction<void()>;
 	FunctorExecutionForwarder();
 	void Forward(FunctorType f) const;
-
-signals:
-	void ExecuteFunctor(FunctorType f) const;
-
-private slots:
-	void OnExecuteFunctor(FunctorType f) const;
 };
 
 }
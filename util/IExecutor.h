@@ -1,9 +1,11 @@
 #pragma once
 
 #include <atomic>
-#include <functional>
+#include <span>
 #include <string>
 
+#include "fnd/MoveOnlyFunction.h"
+
 #include "export/util.h"
 
 namespace HomeCompa::Util
@@ -14,16 +16,18 @@ class UTIL_EXPORT IExecutor
 	static std::atomic<size_t> s_id;
 
 public:
-	using TaskResult = std::function<void(size_t)>;
+	using TaskResult  = MoveOnlyFunction<void(size_t)>;
+	using BatchResult = MoveOnlyFunction<void()>;
 
 	struct Task
 	{
-		std::string                 name;
-		std::function<TaskResult()> task { [] {
+		std::string                    name;
+		MoveOnlyFunction<TaskResult()> task { [] {
 			return [](size_t) {
 			};
 		} };
 		size_t id { ++s_id };
+		bool   displaceable { true }; // false for the batch tasks: the batch waits for every one of them
 	};
 
 public:
@@ -41,6 +45,14 @@ public:
 		return (*const_cast<IExecutor*>(this))(std::move(task), priority, displace);
 	}
 
+	/// all task results of the batch and then onBatchFinished are called together once the last task has finished
+	virtual void operator()(std::span<Task> tasks, BatchResult onBatchFinished, int priority = 0) = 0;
+
+	void operator()(const std::span<Task> tasks, BatchResult onBatchFinished, const int priority = 0) const
+	{
+		(*const_cast<IExecutor*>(this))(tasks, std::move(onBatchFinished), priority);
+	}
+
 	virtual void Stop() = 0;
 };
 
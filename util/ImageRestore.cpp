@@ -102,19 +102,21 @@ public:
 	}
 
 private:
-	bool OnStartElement(const QString& name, const QString& path, const XmlAttributes& attributes) override
+	bool OnStartElementId(const QStringView name, const PathId path, const XmlAttributes& attributes) override
 	{
-		if (name == BINARY)
+		if (name == QLatin1String(BINARY))
+		{
+			SetBinarySink(m_body);
 			return (m_id = attributes.GetAttribute(ID)), true;
+		}
 
-		if (path == COVERPAGE_IMAGE)
+		if (path == m_coverpageImagePath)
 		{
 			for (size_t i = 0, sz = attributes.GetCount(); i < sz; ++i)
 			{
-				auto attributeName  = attributes.GetName(i);
-				auto attributeValue = attributes.GetValue(i);
-				if (attributeName.endsWith(":href"))
+				if (attributes.GetNameView(i).endsWith(QLatin1String(":href")))
 				{
+					auto attributeValue = attributes.GetValue(i);
 					if (const auto it = std::ranges::find_if(
 							attributeValue,
 							[](const auto ch) {
@@ -132,16 +134,16 @@ private:
 		return true;
 	}
 
-	bool OnCharacters(const QString&, const QString& value) override
+	bool OnEndElementId(const QStringView name, PathId) override
 	{
-		if (m_id.isEmpty())
+		if (name != QLatin1String(BINARY) || m_id.isEmpty() || m_body.isEmpty())
 			return true;
 
-		auto       bytes   = QByteArray::fromBase64(value.toUtf8());
 		const auto isCover = m_id == m_coverId;
 		if ((isCover && !(m_imageProcessing & ImageProcessing::RemoveCovers)) || (!isCover && !(m_imageProcessing & ImageProcessing::RemoveImages)))
-			m_covers.emplace(std::move(m_id), std::make_pair(isCover, std::move(bytes)));
-		m_id = QString {};
+			m_covers.emplace(std::move(m_id), std::make_pair(isCover, std::move(m_body)));
+		m_id   = QString {};
+		m_body = QByteArray {};
 
 		return true;
 	}
@@ -149,9 +151,11 @@ private:
 private:
 	const ImageProcessing m_imageProcessing;
 
-	Covers& m_covers;
-	QString m_coverId;
-	QString m_id;
+	Covers&      m_covers;
+	const PathId m_coverpageImagePath { RegisterPath(COVERPAGE_IMAGE) };
+	QString      m_coverId;
+	QString      m_id;
+	QByteArray   m_body;
 };
 
 class SaxPrinter final : public SaxParser
@@ -177,6 +181,7 @@ public:
 		, m_covers { std::move(covers) }
 	{
 		Parse();
+		m_writer.Flush();
 		assert(m_hasProgramUsed);
 	}
 
@@ -1,6 +1,7 @@
 #include "ImageUtil.h"
 
 #include <QBuffer>
+#include <QImageReader>
 #include <QPixmap>
 
 #include "jxl/jxl.h"
@@ -11,7 +12,8 @@ namespace HomeCompa::Util
 namespace
 {
 
-using Decoder = QPixmap (*)(const QByteArray&);
+using Decoder        = QPixmap (*)(const QByteArray&);
+using ReducedDecoder = QImage (*)(const QByteArray&, int minSize);
 using Recoder = std::pair<QByteArray, const char*> (*)(const QByteArray& bytes, const char* type);
 
 std::pair<QByteArray, const char*> QtEncoder(const QImage& image, const QString& format)
@@ -57,6 +59,44 @@ QPixmap JxlDecoder(const QByteArray& data)
 	return QPixmap::fromImage(std::move(image));
 }
 
+constexpr int MAX_JPEG_REDUCTION = 8; // libjpeg scales by 1/2, 1/4 and 1/8 while decoding the DCT blocks
+
+int GetReduction(const QSize& size, const int minSize)
+{
+	int reduction = 1;
+	while (minSize > 0 && std::min(size.width(), size.height()) / (reduction * 2) >= minSize)
+		reduction *= 2;
+	return reduction;
+}
+
+QImage Decimate(QImage image, const int minSize)
+{
+	if (image.isNull())
+		return image;
+
+	const auto reduction = GetReduction(image.size(), minSize);
+	return reduction == 1 ? image : image.scaled(image.width() / reduction, image.height() / reduction, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+}
+
+QImage QtReducedDecoder(const QByteArray& data, const int minSize)
+{
+	QBuffer buffer;
+	buffer.setData(data);
+	buffer.open(QIODevice::ReadOnly);
+
+	QImageReader reader(&buffer);
+	if (const auto size = reader.size(); size.isValid() && reader.format() == JPEG)
+		if (const auto reduction = std::min(GetReduction(size, minSize), MAX_JPEG_REDUCTION); reduction > 1)
+			reader.setScaledSize(QSize((size.width() + reduction - 1) / reduction, (size.height() + reduction - 1) / reduction));
+
+	return Decimate(reader.read(), minSize);
+}
+
+QImage JxlReducedDecoder(const QByteArray& data, const int minSize)
+{
+	return Decimate(JXL::Decode(data, minSize), minSize);
+}
+
 std::pair<QByteArray, const char*> StubRecoder(const QByteArray& data, const char* type)
 {
 	return std::make_pair(data, type);
@@ -74,17 +114,18 @@ std::pair<QByteArray, const char*> JxlRecoder(const QByteArray& data, const char
 
 struct ImageFormatDescription
 {
-	const char* mediaType;
-	Decoder     decoder;
-	Recoder     recoder;
+	const char*    mediaType;
+	Decoder        decoder;
+	ReducedDecoder reducedDecoder;
+	Recoder        recoder;
 };
 
-constexpr ImageFormatDescription DEFAULT_DESCRIPTION { IMAGE_JPEG, &QtDecoder, &QtRecoder };
+constexpr ImageFormatDescription DEFAULT_DESCRIPTION { IMAGE_JPEG, &QtDecoder, &QtReducedDecoder, &QtRecoder };
 
 constexpr std::pair<const char*, ImageFormatDescription> SIGNATURES[] {
-	{ "\xFF\xD8\xFF\xE0", { IMAGE_JPEG, &QtDecoder, &StubRecoder } },
-	{ "\x89\x50\x4E\x47",  { IMAGE_PNG, &QtDecoder, &StubRecoder } },
-	{		 "\xFF\x0A",    { nullptr, &JxlDecoder, &JxlRecoder } },
+	{ "\xFF\xD8\xFF\xE0", { IMAGE_JPEG, &QtDecoder, &QtReducedDecoder, &StubRecoder } },
+	{ "\x89\x50\x4E\x47",  { IMAGE_PNG, &QtDecoder, &QtReducedDecoder, &StubRecoder } },
+	{		 "\xFF\x0A",    { nullptr, &JxlDecoder, &JxlReducedDecoder, &JxlRecoder } },
 };
 
 } // namespace
@@ -99,6 +140,16 @@ QPixmap Decode(const QByteArray& bytes)
 	return decoder(bytes);
 }
 
+QImage DecodeReduced(const QByteArray& bytes, const int minSize)
+{
+	assert(!bytes.isEmpty());
+	const auto it      = std::ranges::find_if(SIGNATURES, [&](const auto& item) {
+		return bytes.startsWith(item.first);
+	});
+	const auto decoder = it != std::end(SIGNATURES) ? it->second.reducedDecoder : &QtReducedDecoder;
+	return decoder(bytes, minSize);
+}
+
 std::pair<QByteArray, const char*> Recode(const QByteArray& bytes)
 {
 	assert(!bytes.isEmpty());
@@ -20,6 +20,10 @@ inline constexpr auto PNG        = "png";
 
 UTIL_EXPORT QImage  HasAlpha(const QImage& image, const char* data = nullptr);
 UTIL_EXPORT QPixmap Decode(const QByteArray& bytes);
+
+/// decodes the image reduced by a power of two while its shorter side stays not less than minSize, non-positive minSize gives the full resolution:
+/// JPEG is scaled in the DCT domain, JPEG XL stops after a detailed enough progressive pass, the rest is decimated after decoding
+UTIL_EXPORT QImage DecodeReduced(const QByteArray& bytes, int minSize);
 UTIL_EXPORT std::pair<QByteArray, const char*> Recode(const QByteArray& bytes);
 UTIL_EXPORT std::pair<QByteArray, const char*> Encode(const QImage& image, const QString& format = {});
 UTIL_EXPORT bool                               IsImage(const QString& fileName);
@@ -18,6 +18,7 @@
 #include "hashbook.h"
 #include "hashxml.h"
 #include "log.h"
+#include "phashindex.h"
 #include "zip.h"
 
 using namespace HomeCompa::Util;
@@ -54,6 +55,8 @@ constexpr auto KEY_HISTOGRAM = "histogram";
 constexpr auto KEY_WORD      = "word";
 constexpr auto KEY_COUNT     = "count";
 
+constexpr auto HAMMING_DISTANCE_THRESHOLD = 16;
+
 using ImageHash   = std::pair<uint64_t, QString>;
 using ImageHashes = std::unordered_multimap<uint64_t, QString>;
 
@@ -93,7 +96,6 @@ CompareResult CompareTexts(QStringList& result, const HashParseResult& lhs, cons
 
 CompareResult FromHammingDistance(const int hammingDistance) noexcept
 {
-	static constexpr auto HAMMING_DISTANCE_THRESHOLD = 16;
 	return hammingDistance == 0 ? CompareResult::None : hammingDistance <= HAMMING_DISTANCE_THRESHOLD ? CompareResult::Images : CompareResult::All;
 }
 
@@ -137,13 +139,9 @@ CompareResult CompareImageHashes(std::multimap<QString, QString>& fileItems, con
 	auto lIds = lhs | std::views::values | std::ranges::to<std::unordered_set<QString>>();
 	auto rIds = rhs | std::views::values | std::ranges::to<std::unordered_set<QString>>();
 
-	if (!(lhs.empty() || rhs.empty()))
-	{
-		std::multimap<int, std::pair<ImageHash, ImageHash>> distances;
-		for (const auto& l : lhs)
-			for (const auto& r : rhs)
-				distances.emplace(std::popcount(l.first ^ r.first), std::make_pair(l, r));
+	using Distances = std::multimap<int, std::pair<ImageHash, ImageHash>>;
 
+	const auto pairUp = [&](const Distances& distances) {
 		for (const auto& [l, r] : distances | std::views::values)
 		{
 			if (!lIds.contains(l.second) || !rIds.contains(r.second))
@@ -165,6 +163,33 @@ CompareResult CompareImageHashes(std::multimap<QString, QString>& fileItems, con
 					.arg(imageCompareResult == CompareResult::All ? "different" : "probably the same")
 			);
 		}
+	};
+
+	if (!(lhs.empty() || rhs.empty()))
+	{
+		// the pairs close enough to be the same image are found through the index first
+		const auto right = rhs | std::ranges::to<std::vector<ImageHash>>();
+		PHashIndex index;
+		index.Reserve(right.size());
+		for (const auto& r : right)
+			index.Add(r.first);
+
+		Distances distances;
+		for (const auto& l : lhs)
+			for (const auto& [id, distance] : index.Find(l.first, HAMMING_DISTANCE_THRESHOLD))
+				distances.emplace(distance, std::make_pair(l, right[id]));
+
+		pairUp(distances);
+
+		// the rest are paired by any distance and reported as different like they always were, usually there are few of them
+		distances.clear();
+		for (const auto& l : lhs)
+			if (lIds.contains(l.second))
+				for (const auto& r : right)
+					if (rIds.contains(r.second))
+						distances.emplace(std::popcount(l.first ^ r.first), std::make_pair(l, r));
+
+		pairUp(distances);
 	}
 
 	const auto notFound = [&](const bool reverse, const QString& id) {
@@ -240,6 +265,8 @@ struct BookHashItemProvider::Impl
 		, fileInfo(path)
 	{
 	}
+
+	BookHashItem Get(const QString& file, QByteArray body) const;
 };
 
 BookHashItemProvider::BookHashItemProvider(const QString& path)
@@ -256,16 +283,32 @@ QStringList BookHashItemProvider::GetFiles() const
 
 BookHashItem BookHashItemProvider::Get(const QString& file) const
 {
-	BookHashItem bookHashItem { .folder = m_impl->fileInfo.fileName(), .file = file, .body = m_impl->zip.Read(file)->GetStream().readAll() };
+	return m_impl->Get(file, m_impl->zip.Read(file)->GetStream().readAll());
+}
+
+void BookHashItemProvider::Get(const QStringList& files, const std::function<void(BookHashItem)>& callback) const
+{
+	m_impl->zip.Extract(
+		files,
+		[&](const QString& file, QByteArray body) {
+			callback(m_impl->Get(file, std::move(body)));
+		},
+		1
+	);
+}
+
+BookHashItem BookHashItemProvider::Impl::Get(const QString& file, QByteArray body) const
+{
+	BookHashItem bookHashItem { .folder = fileInfo.fileName(), .file = file, .body = std::move(body) };
 
 	const auto baseName = QFileInfo(file).completeBaseName();
-	if (m_impl->coversZip && m_impl->covers.contains(baseName))
-		bookHashItem.cover = { QString {}, m_impl->coversZip->Read(baseName)->GetStream().readAll() };
+	if (coversZip && covers.contains(baseName))
+		bookHashItem.cover = { QString {}, coversZip->Read(baseName)->GetStream().readAll() };
 
-	if (m_impl->imagesZip)
+	if (imagesZip)
 		std::ranges::transform(
 			std::ranges::equal_range(
-				m_impl->images,
+				images,
 				baseName + "/",
 				{},
 				[n = baseName.length() + 1](const QString& item) {
@@ -274,7 +317,7 @@ BookHashItem BookHashItemProvider::Get(const QString& file) const
 			),
 			std::back_inserter(bookHashItem.images),
 			[&](const QString& item) {
-				return ImageHashItem { item.split("/").back(), m_impl->imagesZip->Read(item)->GetStream().readAll() };
+				return ImageHashItem { item.split("/").back(), imagesZip->Read(item)->GetStream().readAll() };
 			}
 		);
 
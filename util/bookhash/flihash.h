@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 
 #include <QStringList>
@@ -57,12 +58,32 @@ public:
 	[[nodiscard]] QStringList  GetFiles() const;
 	[[nodiscard]] BookHashItem Get(const QString& file) const;
 
+	/// the books in one batched read of the archive on the calling thread, a solid block is decoded once
+	void Get(const QStringList& files, const std::function<void(BookHashItem)>& callback) const;
+
 private:
 	struct Impl;
 	PropagateConstPtr<Impl> m_impl;
 };
 
+using BookHashCallback = std::function<void(BookHashItem)>;
+
+struct BookHashPipelineSettings
+{
+	unsigned int parseThreadCount { 0 }; // 0: a half of the cores
+	unsigned int imageThreadCount { 0 }; // 0: the rest of the cores
+
+	/// 0: full resolution; otherwise the images are decoded reduced while their shorter side stays not less than this,
+	/// much faster on big scans but the pHashes of such images are not comparable with the full resolution ones
+	int imageDecodeSize { 0 };
+};
+
 UTIL_EXPORT BookHashItem GetHash(const QString& path, const QString& file);
+
+/// hashes every book of the archive: the archive is read on the calling thread, books are parsed and images are hashed on separate pools,
+/// the callback gets the items in archive order
+UTIL_EXPORT void GetHashes(const QString& path, const BookHashCallback& callback, const BookHashPipelineSettings& settings = {});
+
 UTIL_EXPORT std::ostream& operator<<(std::ostream& stream, const BookHashItem& bookHashItem);
 UTIL_EXPORT QByteArray    Serialize(const BookHashItem& bookHashItem);
 UTIL_EXPORT BookHashItem  Deserialize(const QByteArray& bytes);
@@ -0,0 +1,341 @@
+#include "hashbinary.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <QIODevice>
+
+#include "QtTypes.h"
+
+using namespace HomeCompa::Util;
+
+namespace
+{
+
+constexpr std::string_view MAGIC   = "FLHB";
+constexpr uint32_t         VERSION = 1;
+
+constexpr size_t MD5_SIZE = 16;
+
+enum class HashType : uint8_t
+{
+	Empty,
+	Md5,
+	Text,
+};
+
+bool IsMd5(const QString& hash) noexcept
+{
+	return hash.size() == 2 * MD5_SIZE && std::ranges::all_of(hash, [](const QChar ch) {
+			   const auto code = ch.unicode();
+			   return (code >= '0' && code <= '9') || (code >= 'a' && code <= 'f');
+		   });
+}
+
+void WriteVarint(QByteArray& bytes, uint64_t value)
+{
+	for (; value >= 0x80; value >>= 7)
+		bytes.append(static_cast<char>(value | 0x80));
+	bytes.append(static_cast<char>(value));
+}
+
+void WriteFixed(QByteArray& bytes, const uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+		bytes.append(static_cast<char>(value >> (8 * i)));
+}
+
+class RecordWriter
+{
+public:
+	/// the string table followed by the fields
+	void Write(QIODevice& stream, const BookHashItem& bookHashItem)
+	{
+		m_strings.clear();
+		m_table.clear();
+		m_body.clear();
+		m_record.clear();
+
+		WriteString(bookHashItem.folder);
+		WriteString(bookHashItem.file);
+		WriteString(bookHashItem.parseResult.title);
+		WriteHash(bookHashItem.parseResult.id);
+		WriteHash(bookHashItem.parseResult.hashText);
+
+		WriteVarint(m_body, bookHashItem.parseResult.hashValues.size());
+		for (const auto& [count, word] : bookHashItem.parseResult.hashValues)
+		{
+			WriteVarint(m_body, count);
+			WriteString(word);
+		}
+
+		const auto hasCover = !bookHashItem.cover.hash.isEmpty();
+		m_body.append(static_cast<char>(hasCover));
+		if (hasCover)
+			WriteImage(bookHashItem.cover);
+
+		WriteVarint(m_body, bookHashItem.images.size());
+		for (const auto& image : bookHashItem.images)
+			WriteImage(image);
+
+		WriteVarint(m_record, m_strings.size());
+		m_record.append(m_table);
+		m_record.append(m_body);
+
+		QByteArray size;
+		WriteVarint(size, static_cast<uint64_t>(m_record.size()));
+		stream.write(size);
+		stream.write(m_record);
+	}
+
+private:
+	void WriteString(const QString& str)
+	{
+		const auto [it, inserted] = m_strings.try_emplace(str, m_strings.size());
+		if (inserted)
+		{
+			const auto utf8 = str.toUtf8();
+			WriteVarint(m_table, static_cast<uint64_t>(utf8.size()));
+			m_table.append(utf8);
+		}
+		WriteVarint(m_body, it->second);
+	}
+
+	void WriteHash(const QString& hash)
+	{
+		if (hash.isEmpty())
+		{
+			m_body.append(static_cast<char>(HashType::Empty));
+			return;
+		}
+
+		if (IsMd5(hash))
+		{
+			m_body.append(static_cast<char>(HashType::Md5));
+			m_body.append(QByteArray::fromHex(hash.toLatin1()));
+			return;
+		}
+
+		m_body.append(static_cast<char>(HashType::Text));
+		WriteString(hash);
+	}
+
+	void WriteImage(const ImageHashItem& image)
+	{
+		WriteString(image.file);
+		WriteHash(image.hash);
+		WriteFixed(m_body, image.pHash);
+	}
+
+private:
+	std::unordered_map<QString, size_t> m_strings;
+	QByteArray                          m_table;
+	QByteArray                          m_body;
+	QByteArray                          m_record;
+};
+
+class RecordReader
+{
+public:
+	explicit RecordReader(const std::span<const char> data) noexcept
+		: m_data { data }
+	{
+	}
+
+	size_t GetPosition() const noexcept
+	{
+		return m_pos;
+	}
+
+	uint64_t ReadVarint()
+	{
+		uint64_t result = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			const auto byte  = static_cast<uint8_t>(ReadBytes(1).front());
+			result          |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				return result;
+		}
+		throw std::invalid_argument("bad varint");
+	}
+
+	/// little-endian
+	uint64_t ReadFixed(const size_t size = sizeof(uint64_t))
+	{
+		uint64_t   result = 0;
+		const auto bytes  = ReadBytes(size);
+		for (size_t i = 0; i < size; ++i)
+			result |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+		return result;
+	}
+
+	uint8_t ReadByte()
+	{
+		return static_cast<uint8_t>(ReadBytes(1).front());
+	}
+
+	std::string_view ReadBytes(const size_t size)
+	{
+		if (size > m_data.size() - m_pos)
+			throw std::invalid_argument(std::format("unexpected end of data at {}", m_pos));
+
+		const std::string_view result { m_data.data() + m_pos, size };
+		m_pos += size;
+		return result;
+	}
+
+private:
+	const std::span<const char> m_data;
+	size_t                      m_pos { 0 };
+};
+
+std::string_view ReadString(RecordReader& reader, const std::vector<std::string_view>& strings)
+{
+	const auto index = reader.ReadVarint();
+	if (index >= strings.size())
+		throw std::invalid_argument(std::format("bad string index {}", index));
+	return strings[index];
+}
+
+BookHashBinaryReader::Hash ReadHash(RecordReader& reader, const std::vector<std::string_view>& strings)
+{
+	switch (static_cast<HashType>(reader.ReadByte()))
+	{
+		case HashType::Empty:
+			return {};
+		case HashType::Md5:
+			return { .value = reader.ReadBytes(MD5_SIZE), .isMd5 = true };
+		case HashType::Text:
+			return { .value = ReadString(reader, strings) };
+	}
+
+	throw std::invalid_argument("bad hash type");
+}
+
+BookHashBinaryReader::Image ReadImage(RecordReader& reader, const std::vector<std::string_view>& strings)
+{
+	BookHashBinaryReader::Image image;
+	image.file  = ReadString(reader, strings);
+	image.hash  = ReadHash(reader, strings);
+	image.pHash = reader.ReadFixed();
+	return image;
+}
+
+QString ToQString(const std::string_view value)
+{
+	return QString::fromUtf8(value.data(), static_cast<qsizetype_t>(value.size()));
+}
+
+ImageHashItem ToImageHashItem(const BookHashBinaryReader::Image& image)
+{
+	return { .file = ToQString(image.file), .hash = image.hash.ToString(), .pHash = image.pHash };
+}
+
+} // namespace
+
+struct BookHashBinaryWriter::Impl
+{
+	QIODevice&   stream;
+	RecordWriter recordWriter;
+
+	explicit Impl(QIODevice& stream)
+		: stream { stream }
+	{
+		QByteArray header(MAGIC.data(), static_cast<qsizetype_t>(MAGIC.size()));
+		for (size_t i = 0; i < sizeof(VERSION); ++i)
+			header.append(static_cast<char>(VERSION >> (8 * i)));
+		stream.write(header);
+	}
+};
+
+BookHashBinaryWriter::BookHashBinaryWriter(QIODevice& stream)
+	: m_impl(stream)
+{
+}
+
+BookHashBinaryWriter::~BookHashBinaryWriter() = default;
+
+BookHashBinaryWriter& BookHashBinaryWriter::Write(const BookHashItem& bookHashItem)
+{
+	m_impl->recordWriter.Write(m_impl->stream, bookHashItem);
+	return *this;
+}
+
+QString BookHashBinaryReader::Hash::ToString() const
+{
+	return isMd5 ? QString::fromLatin1(QByteArray::fromRawData(value.data(), static_cast<qsizetype_t>(value.size())).toHex()) : ToQString(value);
+}
+
+BookHashItem BookHashBinaryReader::Record::ToItem() const
+{
+	BookHashItem bookHashItem {
+		.folder      = ToQString(folder),
+		.file        = ToQString(file),
+		.parseResult = { .id = id.ToString(), .title = ToQString(title), .hashText = hashText.ToString() },
+	};
+
+	if (hasCover)
+		bookHashItem.cover = ToImageHashItem(cover);
+
+	std::ranges::transform(images, std::back_inserter(bookHashItem.images), &ToImageHashItem);
+	std::ranges::transform(histogram, std::back_inserter(bookHashItem.parseResult.hashValues), [](const auto& item) {
+		return std::make_pair(item.first, ToQString(item.second));
+	});
+
+	return bookHashItem;
+}
+
+BookHashBinaryReader::BookHashBinaryReader(const std::span<const char> data)
+{
+	RecordReader reader(data);
+	if (data.size() < MAGIC.size() + sizeof(VERSION) || reader.ReadBytes(MAGIC.size()) != MAGIC)
+		throw std::invalid_argument("not a binary hash");
+
+	if (const auto version = reader.ReadFixed(sizeof(VERSION)); version != VERSION)
+		throw std::invalid_argument(std::format("unsupported binary hash version {}", version));
+
+	m_data = data.subspan(reader.GetPosition());
+}
+
+bool BookHashBinaryReader::Read(Record& record)
+{
+	if (m_data.empty())
+		return false;
+
+	RecordReader sizeReader(m_data);
+	const auto   size = sizeReader.ReadVarint();
+	const auto   body = sizeReader.ReadBytes(size);
+	m_data            = m_data.subspan(sizeReader.GetPosition());
+
+	RecordReader reader({ body.data(), body.size() });
+
+	record.strings.clear();
+	record.images.clear();
+	record.histogram.clear();
+
+	for (auto n = reader.ReadVarint(); n; --n)
+		record.strings.emplace_back(reader.ReadBytes(reader.ReadVarint()));
+
+	record.folder   = ReadString(reader, record.strings);
+	record.file     = ReadString(reader, record.strings);
+	record.title    = ReadString(reader, record.strings);
+	record.id       = ReadHash(reader, record.strings);
+	record.hashText = ReadHash(reader, record.strings);
+
+	for (auto n = reader.ReadVarint(); n; --n)
+	{
+		const auto count = reader.ReadVarint();
+		record.histogram.emplace_back(count, ReadString(reader, record.strings));
+	}
+
+	record.hasCover = reader.ReadByte() != 0;
+	record.cover    = record.hasCover ? ReadImage(reader, record.strings) : Image {};
+
+	for (auto n = reader.ReadVarint(); n; --n)
+		record.images.emplace_back(ReadImage(reader, record.strings));
+
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "fnd/NonCopyMovable.h"
+#include "fnd/memory.h"
+
+#include "export/util.h"
+
+#include "flihash.h"
+
+class QIODevice;
+
+namespace HomeCompa::Util
+{
+
+/// Versioned binary form of the hash cache: a header followed by the size-prefixed item records.
+/// A record is a length-prefixed UTF-8 string table, then the fields referring to it by index:
+/// md5 hashes are 16 raw bytes, pHashes are fixed 64-bit little-endian, the histogram is varint-encoded.
+class UTIL_EXPORT BookHashBinaryWriter
+{
+	NON_COPY_MOVABLE(BookHashBinaryWriter)
+
+public:
+	/// writes the header
+	explicit BookHashBinaryWriter(QIODevice& stream);
+	~BookHashBinaryWriter();
+
+public:
+	BookHashBinaryWriter& Write(const BookHashItem& bookHashItem);
+
+private:
+	struct Impl;
+	PropagateConstPtr<Impl> m_impl;
+};
+
+/// Iterates the records straight from the bytes, a memory-mapped file for instance: the views point into the data,
+/// the data must outlive the records read
+class UTIL_EXPORT BookHashBinaryReader
+{
+public:
+	/// 16 raw bytes for an md5, UTF-8 text for anything else
+	struct Hash
+	{
+		std::string_view value;
+		bool             isMd5 { false };
+
+		[[nodiscard]] QString ToString() const;
+	};
+
+	struct Image
+	{
+		std::string_view file;
+		Hash             hash;
+		uint64_t         pHash { 0 };
+	};
+
+	struct Record
+	{
+		std::string_view folder;
+		std::string_view file;
+		std::string_view title;
+		Hash             id;
+		Hash             hashText;
+		bool             hasCover { false };
+		Image            cover;
+
+		std::vector<Image>                               images;
+		std::vector<std::pair<size_t, std::string_view>> histogram;
+		std::vector<std::string_view>                    strings;
+
+		[[nodiscard]] BookHashItem ToItem() const;
+	};
+
+public:
+	/// throws on an unknown header or version
+	explicit BookHashBinaryReader(std::span<const char> data);
+
+public:
+	/// false at the end of the data, throws on a broken record; the record buffers are reused
+	bool Read(Record& record);
+
+private:
+	std::span<const char> m_data;
+};
+
+} // namespace HomeCompa::Util
@@ -2,6 +2,7 @@
 
 // clang-format off
 #include <QBuffer>
+#include <QImage>
 #include <QPixmap>
 #include "QtTypes.h"
 
@@ -10,8 +11,6 @@
 
 #include <set>
 
-#include "fnd/ScopedCall.h"
-
 #include "xml/SaxParser.h"
 #include "xml/XmlUtil.h"
 
@@ -19,6 +18,7 @@
 #include "StrUtil.h"
 #include "log.h"
 #include "parser.h"
+#include "phash.h"
 
 #define BOOK_HASH_PARSER_ITEMS_X_MACRO \
 	BOOK_HASH_PARSER_ITEM(fb2)         \
@@ -41,6 +41,9 @@ using namespace cimg_library;
 namespace
 {
 
+// define PHASH_REFERENCE_CHECK to compare every pHash with the generic CImg one, it decodes the image twice when imageDecodeSize is set
+#ifdef PHASH_REFERENCE_CHECK
+
 CImg<float> GetDctMatrix(const int N)
 {
 	const auto  n = static_cast<float>(N);
@@ -56,13 +59,20 @@ const CImg<float> DCT   = GetDctMatrix(32);
 const CImg<float> DCT_T = DCT.get_transpose();
 const CImg<float> MEAN_FILTER(7, 7, 1, 1, 1);
 
-uint64_t GetPHash(const ImageHashItem& item)
+#endif
+
+/// gray image and its part the hash is computed on: the content without the borders if they are big enough
+struct HashSource
 {
-	auto pixmap = Decode(item.body);
-	if (pixmap.isNull())
-		return 0;
+	CImg<uint8_t> img;
+	int           left { 0 };
+	int           top { 0 };
+	int           width { 0 };
+	int           height { 0 };
+};
 
-	auto       image    = pixmap.toImage();
+HashSource GetHashSource(QImage image)
+{
 	const auto hasAlpha = image.pixelFormat().alphaUsage() == QPixelFormat::UsesAlpha;
 	image.convertTo(hasAlpha ? QImage::Format_RGBA8888 : QImage::Format_Grayscale8);
 
@@ -70,51 +80,78 @@ uint64_t GetPHash(const ImageHashItem& item)
 	CImg<uint8_t> img(data, image.width(), image.height(), 1, 1, true);
 	img._is_shared = false;
 
-	if (hasAlpha)
-	{
-		auto* dst = img.data();
-		for (auto h = 0, szh = image.height(), szw = image.width(); h < szh; ++h)
-		{
-			const auto* src = image.scanLine(h);
-			for (auto w = 0; w < szw; ++w, ++dst, src += 4)
-				*dst = static_cast<uint8_t>(std::lround((0.299 * src[0] + 0.587 * src[1] + 0.114 * src[2]) * src[3] / 255.0 + (255.0 - src[3])));
-		}
-	}
-	else
 	{
 		auto* dst = img.data();
 		for (auto h = 0, szh = image.height(), szw = image.width(); h < szh; ++h, dst += szw)
-			memcpy(dst, image.scanLine(h), szw);
+			if (hasAlpha)
+				PHash::RgbaToGray(image.scanLine(h), dst, static_cast<size_t>(szw));
+			else
+				memcpy(dst, image.scanLine(h), szw);
 	}
 
 	const Canny canny;
 	const auto  cropRect = canny.Process(img);
 	static_assert(sizeof(cropRect) == sizeof(uint64_t));
 
-	if (cropRect.width() > img.width() / 2 && cropRect.height() > img.height() / 2)
-		img.crop(cropRect.left, cropRect.top, cropRect.right - 1, cropRect.bottom - 1);
+	HashSource source { .img = std::move(img) };
+	if (cropRect.width() > source.img.width() / 2 && cropRect.height() > source.img.height() / 2)
+	{
+		source.left   = cropRect.left;
+		source.top    = cropRect.top;
+		source.width  = cropRect.width();
+		source.height = cropRect.height();
+	}
+	else
+	{
+		source.width  = source.img.width();
+		source.height = source.img.height();
+	}
+
+	return source;
+}
+
+#ifdef PHASH_REFERENCE_CHECK
 
-	const auto resized = img.get_convolve(MEAN_FILTER).resize(32, 32);
+// the generic CImg implementation, PHash::Compute on the full resolution image must give the same bits
+uint64_t GetPHashReference(const HashSource& source)
+{
+	const auto resized = source.img.get_crop(source.left, source.top, source.left + source.width - 1, source.top + source.height - 1).convolve(MEAN_FILTER).resize(32, 32);
 	const auto dct     = (DCT * resized * DCT_T).crop(1, 1, 8, 8);
 
-#ifndef NDEBUG
-	QString          str;
-	const ScopedCall strGuard([&] {
-		PLOGV << item.file << ": " << str;
+	return std::accumulate(dct._data, dct._data + 64, uint64_t { 0 }, [median = dct.median()](const uint64_t init, const float value) {
+		return init << 1 | (value > median ? 1 : 0);
 	});
+}
+
 #endif
 
-	return std::accumulate(dct._data, dct._data + 64, uint64_t { 0 }, [&, median = dct.median()](const uint64_t init, const float value) {
-		auto result = init << 1;
-		if (value > median)
-			result |= 1;
+/// the full resolution decoding is the one the hashes were always computed with
+QImage Decode(const ImageHashItem& item, const int decodeSize)
+{
+	return decodeSize > 0 ? DecodeReduced(item.body, decodeSize) : Util::Decode(item.body).toImage();
+}
+
+uint64_t GetPHash(const ImageHashItem& item, const int decodeSize)
+{
+	auto image = Decode(item, decodeSize);
+	if (image.isNull())
+		return 0;
+
+	const auto source = GetHashSource(std::move(image));
+	const auto result = PHash::Compute(source.img.data(), source.img.width(), source.left, source.top, source.width, source.height);
 
 #ifndef NDEBUG
-		str.append(value > median ? "1" : "0");
+	PLOGV << item.file << ": " << QString("%1").arg(result, 64, 2, QChar { '0' });
 #endif
 
-		return result;
-	});
+#ifdef PHASH_REFERENCE_CHECK
+	// the reduced decoding changes the bits of some images, the check shows how many
+	const auto reference = decodeSize > 0 ? GetPHashReference(GetHashSource(Decode(item, 0))) : GetPHashReference(source);
+	if (result != reference)
+		PLOGW << item.file << ": pHash differs from the full resolution reference one: " << QString("%1").arg(reference, 64, 2, QChar { '0' });
+#endif
+
+	return result;
 }
 
 using ParserCreator = std::unique_ptr<IParser> (*)(QIODevice& stream);
@@ -218,12 +255,12 @@ private:
 namespace HomeCompa::Util
 {
 
-void SetHash(ImageHashItem& item, QCryptographicHash& cryptographicHash)
+void SetHash(ImageHashItem& item, QCryptographicHash& cryptographicHash, const int decodeSize)
 {
 	cryptographicHash.reset();
 	cryptographicHash.addData(item.body);
 	item.hash  = QString::fromUtf8(cryptographicHash.result().toHex());
-	item.pHash = GetPHash(item);
+	item.pHash = GetPHash(item, decodeSize);
 	item.body.clear();
 #ifdef ADDITIONAL_LOG_ENABLED
 	PLOGV << item.file;
@@ -246,7 +283,7 @@ CalculateHashResult CalculateHash(Hist& hist)
 	return { .hashValues = std::move(hashValues.first), .hash = std::move(hash), .count = count, .size = hashValues.second };
 }
 
-void ParseBookHash(BookHashItem& bookHashItem, QCryptographicHash& cryptographicHash)
+void ParseBookContent(BookHashItem& bookHashItem)
 {
 	QBuffer buffer(&bookHashItem.body);
 	buffer.open(QIODevice::ReadOnly);
@@ -259,18 +296,29 @@ void ParseBookHash(BookHashItem& bookHashItem, QCryptographicHash& cryptographic
 	if (auto images = parser->GetImages(); !images.empty())
 		bookHashItem.images = std::move(images);
 
+	bookHashItem.body.clear();
+}
+
+void SortImages(ImageHashItems& images)
+{
+	std::ranges::sort(images, {}, [](const auto& item) {
+		auto       ok     = false;
+		const auto number = item.file.toLongLong(&ok);
+		return ok ? QString("%1").arg(number, 16, 10, QChar { '0' }) : item.file;
+	});
+}
+
+void ParseBookHash(BookHashItem& bookHashItem, QCryptographicHash& cryptographicHash)
+{
+	ParseBookContent(bookHashItem);
+
 	if (!bookHashItem.cover.body.isEmpty())
 		SetHash(bookHashItem.cover, cryptographicHash);
 
 	std::ranges::for_each(bookHashItem.images, [&](auto& item) {
 		SetHash(item, cryptographicHash);
 	});
-	std::ranges::sort(bookHashItem.images, {}, [](const auto& item) {
-		auto       ok     = false;
-		const auto number = item.file.toLongLong(&ok);
-		return ok ? QString("%1").arg(number, 16, 10, QChar { '0' }) : item.file;
-	});
-	bookHashItem.body.clear();
+	SortImages(bookHashItem.images);
 }
 
 Hist CollectHistogram(QByteArray body, QCryptographicHash& md5)
@@ -25,6 +25,11 @@ struct CalculateHashResult
 
 UTIL_EXPORT CalculateHashResult CalculateHash(Hist& hist);
 
-void SetHash(ImageHashItem& item, QCryptographicHash& cryptographicHash);
+/// non-zero decodeSize decodes the image reduced to that shorter side, see BookHashPipelineSettings::imageDecodeSize
+void SetHash(ImageHashItem& item, QCryptographicHash& cryptographicHash, int decodeSize = 0);
+
+/// ParseBookHash steps for callers that hash the images separately
+void ParseBookContent(BookHashItem& bookHashItem);
+void SortImages(ImageHashItems& images);
 
 }
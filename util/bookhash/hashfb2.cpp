@@ -97,18 +97,18 @@ private: // BookHash::IParser
 	}
 
 private: // Util::SaxParser
-	bool OnStartElement(const QString& name, const QString& path, const XmlAttributes& attributes) override
+	bool OnStartElementId(const QStringView name, const PathId path, const XmlAttributes& attributes) override
 	{
-		if (name == SECTION)
+		if (name == QLatin1String(SECTION))
 		{
 			m_currentSection = m_currentSection->children.emplace_back(std::make_unique<Section>(m_currentSection, m_currentSection->depth + 1)).get();
 			return true;
 		}
 
-		if (IsOneOf(path, BINARY, BODY_BINARY))
+		if (IsOneOf(path, m_binaryPath, m_bodyBinaryPath))
 		{
-			m_isBinary = true;
-			m_picId    = attributes.GetAttribute(ID).trimmed();
+			SetBinarySink(m_binary);
+			m_picId = attributes.GetAttribute(ID).trimmed();
 			if (const auto it = std::ranges::find_if(
 					m_picId,
 					[](const auto ch) {
@@ -120,20 +120,19 @@ private: // Util::SaxParser
 			return true;
 		}
 
-		if (path == ANNOTATION)
+		if (path == m_annotationPath)
 		{
 			m_isAnnotation = true;
 			return true;
 		}
 
-		if (path == COVERPAGE_IMAGE)
+		if (path == m_coverpageImagePath)
 		{
 			for (size_t i = 0, sz = attributes.GetCount(); i < sz; ++i)
 			{
-				auto attributeName  = attributes.GetName(i);
-				auto attributeValue = attributes.GetValue(i);
-				if (attributeName.endsWith(":href"))
+				if (attributes.GetNameView(i).endsWith(QLatin1String(":href")))
 				{
+					auto attributeValue = attributes.GetValue(i);
 					if (const auto it = std::ranges::find_if(
 							attributeValue,
 							[](const auto ch) {
@@ -150,19 +149,19 @@ private: // Util::SaxParser
 		return true;
 	}
 
-	bool OnEndElement(const QString& name, const QString& path) override
+	bool OnEndElementId(const QStringView name, const PathId path) override
 	{
-		if (IsOneOf(path, BINARY, BODY_BINARY))
+		if (IsOneOf(path, m_binaryPath, m_bodyBinaryPath))
 		{
-			m_isBinary = false;
+			OnBinary();
 		}
-		else if (name == SECTION)
+		else if (name == QLatin1String(SECTION))
 		{
 			m_currentSection->GetHashValues();
 			m_currentSection = m_currentSection->parent;
 			assert(m_currentSection);
 		}
-		else if (path == ANNOTATION)
+		else if (path == m_annotationPath)
 		{
 			m_isAnnotation = false;
 		}
@@ -170,36 +169,19 @@ private: // Util::SaxParser
 		return true;
 	}
 
-	bool OnCharacters(const QString& path, const QString& value) override
+	bool OnCharactersId(const PathId path, const QStringView value) override
 	{
-		if (!m_picId.isEmpty())
-		{
-			if (!m_isBinary || !IsOneOf(path, BINARY, BODY_BINARY))
-			{
-				PLOGW << "bad binary";
-				m_picId = QString {};
-				return true;
-			}
-
-			const auto isCover       = m_picId == m_coverPage;
-			auto&      imageItemHash = isCover ? m_cover : m_images.emplace_back();
-			imageItemHash            = { .file = std::move(m_picId), .body = QByteArray::fromBase64(value.toUtf8()) };
-			m_picId                  = QString {};
-
-			return true;
-		}
-
 		if (m_isAnnotation)
-			m_annotation << value;
+			m_annotation << value.toString();
 
-		auto valueCopy = value;
+		auto valueCopy = value.toString();
 
 		PrepareTitle(valueCopy);
 
-		if (path == TITLE)
+		if (path == m_titlePath)
 			return (m_title = SimplifyTitle(valueCopy)), true;
 
-		if (path.startsWith(BODY, Qt::CaseInsensitive))
+		if (IsInside(m_bodyPath))
 		{
 			for (auto&& word : valueCopy.split(' ', Qt::SkipEmptyParts))
 			{
@@ -226,6 +208,25 @@ private: // Util::SaxParser
 	}
 
 private:
+	void OnBinary()
+	{
+		if (m_picId.isEmpty())
+			return;
+
+		if (m_binary.isEmpty())
+		{
+			PLOGW << "bad binary";
+			m_picId = QString {};
+			return;
+		}
+
+		const auto isCover       = m_picId == m_coverPage;
+		auto&      imageItemHash = isCover ? m_cover : m_images.emplace_back();
+		imageItemHash            = { .file = std::move(m_picId), .body = std::move(m_binary) };
+		m_picId                  = QString {};
+		m_binary                 = QByteArray {};
+	}
+
 	void UpdateHash(QString value)
 	{
 		RemoveIf(value, [](const QChar ch) {
@@ -235,6 +236,13 @@ private:
 	}
 
 private:
+	const PathId m_bodyPath { RegisterPath(BODY) };
+	const PathId m_binaryPath { RegisterPath(BINARY) };
+	const PathId m_bodyBinaryPath { RegisterPath(BODY_BINARY) };
+	const PathId m_titlePath { RegisterPath(TITLE) };
+	const PathId m_coverpageImagePath { RegisterPath(COVERPAGE_IMAGE) };
+	const PathId m_annotationPath { RegisterPath(ANNOTATION) };
+
 	QString            m_title;
 	Section            m_section;
 	Section*           m_currentSection { &m_section };
@@ -244,10 +252,10 @@ private:
 	ImageHashItems m_images;
 	QStringList    m_annotation;
 
-	bool    m_isAnnotation { false };
-	bool    m_isBinary { false };
-	QString m_coverPage;
-	QString m_picId;
+	bool       m_isAnnotation { false };
+	QString    m_coverPage;
+	QString    m_picId;
+	QByteArray m_binary;
 };
 
 } // namespace
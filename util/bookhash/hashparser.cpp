@@ -31,13 +31,13 @@ public:
 	}
 
 private: // Util::SaxParser
-	bool OnStartElement(const QString& name, const QString& path, const XmlAttributes& attributes) override
+	bool OnStartElementId(const QStringView name, const PathId path, const XmlAttributes& attributes) override
 	{
-		if (path == BOOKS)
+		if (path == m_booksPath)
 		{
 			m_observer.OnParseStarted(attributes.GetAttribute("source"));
 		}
-		else if (path == BOOK)
+		else if (path == m_bookPath)
 		{
 #define HASH_PARSER_CALLBACK_ITEM(NAME) m_##NAME = attributes.GetAttribute(#NAME);
 			HASH_PARSER_CALLBACK_ITEMS_X_MACRO
@@ -45,12 +45,12 @@ private: // Util::SaxParser
 			m_section        = std::make_unique<HashParser::Section>();
 			m_currentSection = m_section.get();
 		}
-		else if (path == ORIGIN)
+		else if (path == m_originPath)
 		{
 			m_originFolder = attributes.GetAttribute(Inpx::FOLDER);
 			m_originFile   = attributes.GetAttribute(Inpx::FILE);
 		}
-		else if (name == SECTION)
+		else if (name == QLatin1String(SECTION))
 		{
 			auto& section    = m_currentSection->children.try_emplace(attributes.GetAttribute("id"), std::make_unique<HashParser::Section>()).first->second;
 			section->count   = attributes.GetAttribute("count").toULongLong();
@@ -58,15 +58,15 @@ private: // Util::SaxParser
 			section->parent  = m_currentSection;
 			m_currentSection = section.get();
 		}
-		else if (path == COVER)
+		else if (path == m_coverPath)
 		{
 			m_cover.pHash = attributes.GetAttribute("pHash");
 		}
-		else if (path == IMAGE)
+		else if (path == m_imagePath)
 		{
 			m_images.emplace_back(attributes.GetAttribute("id"), QString(), attributes.GetAttribute("pHash"));
 		}
-		else if (path == HISTOGRAM)
+		else if (path == m_histogramPath)
 		{
 			m_textHistogram.emplace_back(attributes.GetAttribute("count").toULongLong(), attributes.GetAttribute("word"));
 		}
@@ -74,9 +74,9 @@ private: // Util::SaxParser
 		return true;
 	}
 
-	bool OnEndElement(const QString& name, const QString& path) override
+	bool OnEndElementId(const QStringView name, const PathId path) override
 	{
-		if (path == BOOK)
+		if (path == m_bookPath)
 		{
 			assert(!m_id.isEmpty());
 			if (!m_observer.OnBookParsed(
@@ -102,7 +102,7 @@ private: // Util::SaxParser
 			m_annotation     = QStringList {};
 			m_currentSection = nullptr;
 		}
-		else if (name == SECTION)
+		else if (name == QLatin1String(SECTION))
 		{
 			m_currentSection = m_currentSection->parent;
 		}
@@ -110,19 +110,28 @@ private: // Util::SaxParser
 		return true;
 	}
 
-	bool OnCharacters(const QString& path, const QString& value) override
+	bool OnCharactersId(const PathId path, const QStringView value) override
 	{
-		if (path == COVER)
-			m_cover.hash = value;
-		else if (path == IMAGE)
-			m_images.back().hash = value;
-		else if (path == ANNOTATION)
-			m_annotation << value;
+		if (path == m_coverPath)
+			m_cover.hash = value.toString();
+		else if (path == m_imagePath)
+			m_images.back().hash = value.toString();
+		else if (path == m_annotationPath)
+			m_annotation << value.toString();
 		return true;
 	}
 
 private:
 	HashParser::IObserver& m_observer;
+
+	const PathId m_booksPath { RegisterPath(BOOKS) };
+	const PathId m_bookPath { RegisterPath(BOOK) };
+	const PathId m_coverPath { RegisterPath(COVER) };
+	const PathId m_imagePath { RegisterPath(IMAGE) };
+	const PathId m_originPath { RegisterPath(ORIGIN) };
+	const PathId m_histogramPath { RegisterPath(HISTOGRAM) };
+	const PathId m_annotationPath { RegisterPath(ANNOTATION) };
+
 #define HASH_PARSER_CALLBACK_ITEM(NAME) QString m_##NAME;
 	HASH_PARSER_CALLBACK_ITEMS_X_MACRO
 #undef HASH_PARSER_CALLBACK_ITEM
@@ -0,0 +1,171 @@
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
+#include <QCryptographicHash>
+
+#include "executor/ThreadPool.h"
+
+#include "flihash.h"
+#include "hashbook.h"
+#include "log.h"
+
+using namespace HomeCompa::Util;
+using namespace HomeCompa;
+
+namespace
+{
+
+using HashContext = std::unique_ptr<QCryptographicHash>;
+using HashPool    = ThreadPool<HashContext>;
+
+constexpr size_t REORDER_WINDOW_PER_THREAD = 4;
+
+HashPool::Initializer GetPoolInitializer(const unsigned int threadCount)
+{
+	return {
+		.threadCount   = threadCount,
+		.maxQueueSize  = 2ULL * threadCount,
+		.contextGetter = [](size_t) {
+			return std::make_unique<QCryptographicHash>(QCryptographicHash::Md5);
+		},
+	};
+}
+
+/// emits the books in archive order whatever order they are completed in;
+/// the producer waits for its turn so that no more than the window of completed books is buffered behind a slow one
+class OrderedEmitter
+{
+public:
+	OrderedEmitter(const BookHashCallback& callback, const size_t window)
+		: m_callback { callback }
+		, m_window { window }
+	{
+	}
+
+	void WaitForSlot(const size_t index)
+	{
+		std::unique_lock lock(m_guard);
+		m_condition.wait(lock, [&] {
+			return index < m_next + m_window;
+		});
+	}
+
+	void Complete(const size_t index, BookHashItem item)
+	{
+		{
+			std::lock_guard lock(m_guard);
+			m_completed.emplace(index, std::move(item));
+			for (auto it = m_completed.begin(); it != m_completed.end() && it->first == m_next; it = m_completed.erase(it), ++m_next)
+				m_callback(std::move(it->second));
+		}
+		m_condition.notify_all();
+	}
+
+private:
+	const BookHashCallback&        m_callback;
+	const size_t                   m_window;
+	std::mutex                     m_guard;
+	std::condition_variable        m_condition;
+	std::map<size_t, BookHashItem> m_completed;
+	size_t                         m_next { 0 };
+};
+
+/// a book waiting for its cover and images to be hashed on the image pool
+struct PendingBook
+{
+	size_t             index;
+	BookHashItem       item;
+	std::atomic_size_t remaining;
+	OrderedEmitter&    emitter;
+
+	void OnImageHashed()
+	{
+		if (--remaining)
+			return;
+
+		SortImages(item.images);
+		emitter.Complete(index, std::move(item));
+	}
+};
+
+} // namespace
+
+namespace HomeCompa::Util
+{
+
+void GetHashes(const QString& path, const BookHashCallback& callback, const BookHashPipelineSettings& settings)
+{
+	const auto cpuCount         = std::max(std::thread::hardware_concurrency(), 2u);
+	const auto parseThreadCount = settings.parseThreadCount ? settings.parseThreadCount : std::max(cpuCount / 2, 1u);
+	const auto imageThreadCount = settings.imageThreadCount ? settings.imageThreadCount : std::max(cpuCount - parseThreadCount, 1u);
+
+	OrderedEmitter emitter(callback, REORDER_WINDOW_PER_THREAD * (parseThreadCount + imageThreadCount));
+
+	// declared first, destroyed last: parse tasks feed it until the parse pool is done
+	HashPool imagePool(GetPoolInitializer(imageThreadCount));
+	HashPool parsePool(GetPoolInitializer(parseThreadCount));
+
+	const auto enqueueImage = [&](const std::shared_ptr<PendingBook>& book, ImageHashItem& image) {
+		imagePool.enqueue([book, &image, decodeSize = settings.imageDecodeSize](HashContext& md5, const std::stop_token&) {
+			try
+			{
+				SetHash(image, *md5, decodeSize);
+			}
+			catch (const std::exception& ex)
+			{
+				PLOGE << book->item.folder << "/" << book->item.file << "/" << image.file << ": " << ex.what();
+				image.pHash = 0;
+				image.body.clear();
+			}
+			catch (...)
+			{
+				PLOGE << book->item.folder << "/" << book->item.file << "/" << image.file << ": unknown error";
+				image.pHash = 0;
+				image.body.clear();
+			}
+			book->OnImageHashed();
+		});
+	};
+
+	const BookHashItemProvider provider(path);
+	const auto                 files = provider.GetFiles();
+	PLOGI << QString("hashing %1 book(s) from %2: %3 parse and %4 image thread(s)").arg(files.size()).arg(path).arg(parseThreadCount).arg(imageThreadCount);
+
+	// the books come in archive order, the emitter keeps it
+	size_t nextIndex = 0;
+	provider.Get(files, [&](BookHashItem bookHashItem) {
+		const auto index = nextIndex++;
+		emitter.WaitForSlot(index);
+		parsePool.enqueue([&, index, item = std::move(bookHashItem)](HashContext&, const std::stop_token&) mutable {
+			try
+			{
+				ParseBookContent(item);
+			}
+			catch (const std::exception& ex)
+			{
+				PLOGE << item.folder << "/" << item.file << ": " << ex.what();
+			}
+			catch (...)
+			{
+				PLOGE << item.folder << "/" << item.file << ": unknown error";
+			}
+
+			const auto imageCount = item.images.size() + (item.cover.body.isEmpty() ? 0 : 1);
+			if (imageCount == 0)
+				return emitter.Complete(index, std::move(item));
+
+			auto book = std::make_shared<PendingBook>(index, std::move(item), imageCount, emitter);
+			if (!book->item.cover.body.isEmpty())
+				enqueueImage(book, book->item.cover);
+			for (auto& image : book->item.images)
+				enqueueImage(book, image);
+		});
+	});
+
+	parsePool.wait();
+	imagePool.wait();
+}
+
+} // namespace HomeCompa::Util
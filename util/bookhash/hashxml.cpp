@@ -1,8 +1,16 @@
 #include "hashxml.h"
 
+#include <algorithm>
+#include <cctype>
+#include <list>
+#include <mutex>
 #include <ranges>
+#include <unordered_map>
 
+#include <QBuffer>
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
 
 #include "fnd/StrUtil.h"
 
@@ -13,17 +21,222 @@ using namespace HomeCompa::Util;
 namespace
 {
 
+constexpr std::string_view BOOK_START = "<book";
+constexpr std::string_view BOOK_END   = "</book>";
+constexpr std::string_view FILE_NAME  = "file";
+
+/// the predefined entities only: the attribute values are written by XmlWriter
+QString DecodeAttributeValue(const std::string_view value)
+{
+	static constexpr std::pair<std::string_view, char> ENTITIES[] {
+		{  "&amp;",  '&' },
+		{   "&lt;",  '<' },
+		{   "&gt;",  '>' },
+		{ "&quot;",  '"' },
+		{ "&apos;", '\'' },
+	};
+
+	std::string result;
+	result.reserve(value.size());
+	for (size_t i = 0; i < value.size(); ++i)
+	{
+		const auto it = value[i] != '&' ? std::end(ENTITIES) : std::ranges::find_if(ENTITIES, [tail = value.substr(i)](const auto& item) {
+			return tail.starts_with(item.first);
+		});
+
+		if (it == std::end(ENTITIES))
+		{
+			result.push_back(value[i]);
+			continue;
+		}
+
+		result.push_back(it->second);
+		i += it->first.size() - 1;
+	}
+
+	return QString::fromStdString(result);
+}
+
+/// value of the attribute in the start tag text
+std::string_view FindAttribute(std::string_view tag, const std::string_view name)
+{
+	while (true)
+	{
+		const auto eq = tag.find('=');
+		if (eq == std::string_view::npos || eq + 1 >= tag.size())
+			return {};
+
+		auto attributeName = tag.substr(0, eq);
+		while (!attributeName.empty() && std::isspace(static_cast<unsigned char>(attributeName.back())))
+			attributeName.remove_suffix(1);
+		attributeName = attributeName.substr(std::min(attributeName.find_last_of(" \t\r\n") + 1, attributeName.size()));
+
+		const auto quoteBegin = tag.find_first_of("\"'", eq + 1);
+		if (quoteBegin == std::string_view::npos)
+			return {};
+
+		const auto quoteEnd = tag.find(tag[quoteBegin], quoteBegin + 1);
+		if (quoteEnd == std::string_view::npos)
+			return {};
+
+		if (attributeName == name)
+			return tag.substr(quoteBegin + 1, quoteEnd - quoteBegin - 1);
+
+		tag.remove_prefix(quoteEnd + 1);
+	}
+}
+
+/// the closing bracket of the start tag, the attribute values may contain '>' and '/' as XmlWriter does not escape them
+size_t FindTagEnd(const std::string_view data, size_t pos)
+{
+	for (char quote = 0; pos < data.size(); ++pos)
+	{
+		const auto ch = data[pos];
+		if (quote)
+		{
+			if (ch == quote)
+				quote = 0;
+		}
+		else if (ch == '"' || ch == '\'')
+		{
+			quote = ch;
+		}
+		else if (ch == '>')
+		{
+			return pos;
+		}
+	}
+
+	return std::string_view::npos;
+}
+
+/// byte ranges of the books in a hash xml, a single scan of the mapped file instead of a parse per lookup
+class XmlHashIndex
+{
+public:
+	using Range = std::pair<qint64, qint64>;
+
+public:
+	/// the index is kept while the file is not changed, for the recently used files only
+	static std::shared_ptr<const XmlHashIndex> Get(const QString& path)
+	{
+		static constexpr size_t MAX_CACHE_SIZE = 8;
+
+		using Item = std::pair<QString, std::shared_ptr<const XmlHashIndex>>;
+		static std::mutex      guard;
+		static std::list<Item> cache;
+
+		const QFileInfo fileInfo(path);
+		const auto      absolutePath = fileInfo.absoluteFilePath();
+		const auto      lastModified = fileInfo.lastModified();
+		const auto      size         = fileInfo.size();
+
+		const auto find = [&]() -> std::shared_ptr<const XmlHashIndex> {
+			const auto it = std::ranges::find(cache, absolutePath, &Item::first);
+			if (it == cache.end() || it->second->m_lastModified != lastModified || it->second->m_size != size)
+				return {};
+
+			cache.splice(cache.begin(), cache, it);
+			return it->second;
+		};
+
+		{
+			std::scoped_lock lock(guard);
+			if (auto index = find())
+				return index;
+		}
+
+		// the scan of a big file does not block the lookups of the other ones
+		auto index = std::make_shared<const XmlHashIndex>(path, lastModified, size);
+
+		std::scoped_lock lock(guard);
+		if (auto cached = find())
+			return cached;
+
+		std::erase_if(cache, [&](const Item& item) {
+			return item.first == absolutePath;
+		});
+		cache.emplace_front(absolutePath, index);
+		if (cache.size() > MAX_CACHE_SIZE)
+			cache.pop_back();
+
+		return index;
+	}
+
+	XmlHashIndex(const QString& path, QDateTime lastModified, const qint64 size)
+		: m_lastModified { std::move(lastModified) }
+		, m_size { size }
+	{
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly))
+			throw std::invalid_argument(std::format("Cannot read from {}", path));
+
+		if (auto* data = file.map(0, file.size()))
+		{
+			Build({ reinterpret_cast<const char*>(data), static_cast<size_t>(file.size()) });
+			file.unmap(data);
+		}
+	}
+
+	bool IsEmpty() const noexcept
+	{
+		return m_ranges.empty();
+	}
+
+	/// the book element alone in a books document
+	QByteArray GetBook(const QString& path, const QString& fileName) const
+	{
+		const auto it = m_ranges.find(fileName);
+		if (it == m_ranges.end())
+			return {};
+
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly) || !file.seek(it->second.first))
+			throw std::invalid_argument(std::format("Cannot read from {}", path));
+
+		return QByteArray(R"(<?xml version="1.0" encoding="UTF-8"?><books>)") + file.read(it->second.second - it->second.first) + QByteArray("</books>");
+	}
+
+private:
+	void Build(const std::string_view data)
+	{
+		for (size_t pos = data.find(BOOK_START); pos != std::string_view::npos; pos = data.find(BOOK_START, pos + 1))
+		{
+			const auto next = pos + BOOK_START.size();
+			if (next >= data.size() || !(std::isspace(static_cast<unsigned char>(data[next])) || data[next] == '>' || data[next] == '/'))
+				continue;
+
+			const auto tagEnd = FindTagEnd(data, next);
+			if (tagEnd == std::string_view::npos)
+				return;
+
+			const auto tag = data.substr(next, tagEnd - next);
+			auto       end = tag.ends_with('/') ? tagEnd + 1 : data.find(BOOK_END, tagEnd);
+			if (end == std::string_view::npos)
+				return;
+
+			if (!tag.ends_with('/'))
+				end += BOOK_END.size();
+
+			// the first book of the name is found as the sequential scan does
+			m_ranges.try_emplace(DecodeAttributeValue(FindAttribute(tag, FILE_NAME)), static_cast<qint64>(pos), static_cast<qint64>(end));
+			pos = end - 1;
+		}
+	}
+
+private:
+	const QDateTime                    m_lastModified;
+	const qint64                       m_size;
+	std::unordered_map<QString, Range> m_ranges;
+};
+
 class XmlHashGetter final : HashParser::IObserver
 {
 public:
-	XmlHashGetter(BookHashItem& bookHashItem, const QString& path, QString file)
+	XmlHashGetter(BookHashItem& bookHashItem, QIODevice& stream, QString file)
 		: m_bookHashItem { bookHashItem }
 		, m_file { std::move(file) }
 	{
-		QFile stream(path);
-		if (!stream.open(QIODevice::ReadOnly))
-			throw std::invalid_argument(std::format("Cannot read from {}", path));
-
 		HashParser::Parse(stream, *this);
 	}
 
@@ -74,8 +287,26 @@ namespace HomeCompa::Util
 
 BookHashItem ParseXmlHash(const QString& path, const QString& file)
 {
-	BookHashItem        bookHashItem;
-	const XmlHashGetter xmlHashGetter(bookHashItem, path, file);
+	BookHashItem bookHashItem;
+
+	if (const auto index = XmlHashIndex::Get(path); !index->IsEmpty())
+	{
+		if (auto book = index->GetBook(path, file); !book.isEmpty())
+		{
+			QBuffer stream(&book);
+			stream.open(QIODevice::ReadOnly);
+			[[maybe_unused]] const XmlHashGetter xmlHashGetter(bookHashItem, stream, file);
+		}
+	}
+	else
+	{
+		QFile stream(path);
+		if (!stream.open(QIODevice::ReadOnly))
+			throw std::invalid_argument(std::format("Cannot read from {}", path));
+
+		[[maybe_unused]] const XmlHashGetter xmlHashGetter(bookHashItem, stream, file);
+	}
+
 	if (bookHashItem.folder.isEmpty())
 		throw std::invalid_argument(std::format("cannot find {} in {}", file, path));
 	return bookHashItem;
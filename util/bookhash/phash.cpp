@@ -0,0 +1,207 @@
+#include "phash.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+#if defined(__AVX2__)
+#define PHASH_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PHASH_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace HomeCompa::Util::PHash
+{
+
+namespace
+{
+
+constexpr int SIZE       = 32;
+constexpr int BLOCK      = 8;
+constexpr int MEAN_SIZE  = 7;
+constexpr int MEAN_DELTA = MEAN_SIZE / 2;
+
+using DctMatrix = std::array<std::array<float, SIZE>, SIZE>;
+
+// the same float values as the CImg DCT matrix previously used: dct[frequency][position]
+DctMatrix CreateDctMatrix()
+{
+	constexpr auto n  = static_cast<float>(SIZE);
+	const auto     c0 = 1 / std::sqrt(n);
+	const auto     c1 = std::sqrt(2.0f / n);
+
+	DctMatrix result {};
+	for (int x = 0; x < SIZE; ++x)
+		result[0][x] = c0;
+
+	for (int x = 0; x < SIZE; ++x)
+		for (int y = 1; y < SIZE; ++y)
+			result[y][x] = c1 * static_cast<float>(std::cos((std::numbers::pi / 2.0 / SIZE) * y * (2.0 * x + 1)));
+
+	return result;
+}
+
+const DctMatrix DCT = CreateDctMatrix();
+
+// lround for non-negative values: the fraction is exact, so the comparison with .5 gives the same result
+uint8_t RoundGray(const double value) noexcept
+{
+	const auto integral = static_cast<int>(value);
+	return static_cast<uint8_t>(integral + (value - integral >= 0.5 ? 1 : 0));
+}
+
+double GrayValue(const uint8_t* src) noexcept
+{
+	return (0.299 * src[0] + 0.587 * src[1] + 0.114 * src[2]) * src[3] / 255.0 + (255.0 - src[3]);
+}
+
+#if defined(PHASH_SSE2)
+
+// 2 pixels from 2 packed RGBA int32 lanes, every operation is the scalar one in the same order
+__m128i GrayValue2(const __m128i rgba) noexcept
+{
+	const auto mask = _mm_set1_epi32(0xFF);
+	const auto r    = _mm_cvtepi32_pd(_mm_and_si128(rgba, mask));
+	const auto g    = _mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(rgba, 8), mask));
+	const auto b    = _mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(rgba, 16), mask));
+	const auto a    = _mm_cvtepi32_pd(_mm_srli_epi32(rgba, 24));
+
+	auto value = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(0.299), r), _mm_mul_pd(_mm_set1_pd(0.587), g)), _mm_mul_pd(_mm_set1_pd(0.114), b));
+	value      = _mm_add_pd(_mm_div_pd(_mm_mul_pd(value, a), _mm_set1_pd(255.0)), _mm_sub_pd(_mm_set1_pd(255.0), a));
+
+	const auto integral = _mm_cvttpd_epi32(value);
+	const auto round    = _mm_castpd_si128(_mm_cmpge_pd(_mm_sub_pd(value, _mm_cvtepi32_pd(integral)), _mm_set1_pd(0.5)));
+	return _mm_sub_epi32(integral, _mm_shuffle_epi32(round, _MM_SHUFFLE(3, 3, 2, 0)));
+}
+
+#endif
+
+#if defined(PHASH_AVX2)
+
+__m128i GrayValue4(const __m128i rgba) noexcept
+{
+	const auto mask = _mm_set1_epi32(0xFF);
+	const auto r    = _mm256_cvtepi32_pd(_mm_and_si128(rgba, mask));
+	const auto g    = _mm256_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(rgba, 8), mask));
+	const auto b    = _mm256_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(rgba, 16), mask));
+	const auto a    = _mm256_cvtepi32_pd(_mm_srli_epi32(rgba, 24));
+
+	auto value = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(0.299), r), _mm256_mul_pd(_mm256_set1_pd(0.587), g)), _mm256_mul_pd(_mm256_set1_pd(0.114), b));
+	value      = _mm256_add_pd(_mm256_div_pd(_mm256_mul_pd(value, a), _mm256_set1_pd(255.0)), _mm256_sub_pd(_mm256_set1_pd(255.0), a));
+
+	const auto integral = _mm256_cvttpd_epi32(value);
+	const auto round    = _mm256_cmp_pd(_mm256_sub_pd(value, _mm256_cvtepi32_pd(integral)), _mm256_set1_pd(0.5), _CMP_GE_OQ);
+	const auto round32  = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(round), _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+	return _mm_sub_epi32(integral, round32);
+}
+
+#endif
+
+template <size_t N>
+float Median(std::array<float, N> values) noexcept
+{
+	// CImg::median() for an even count: the mean of the two middle values
+	static_assert(N % 2 == 0);
+	std::ranges::nth_element(values, values.begin() + N / 2);
+	const auto upper = values[N / 2];
+	const auto lower = *std::max_element(values.begin(), values.begin() + N / 2);
+	return (upper + lower) / 2;
+}
+
+} // namespace
+
+void RgbaToGray(const uint8_t* src, uint8_t* dst, const size_t pixelCount) noexcept
+{
+	size_t i = 0;
+
+#if defined(PHASH_AVX2)
+	for (; i + 4 <= pixelCount; i += 4, src += 16, dst += 4)
+	{
+		const auto gray  = GrayValue4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+		const auto words = _mm_packs_epi32(gray, gray);
+		const auto bytes = _mm_packus_epi16(words, words);
+		*reinterpret_cast<uint32_t*>(dst) = static_cast<uint32_t>(_mm_cvtsi128_si32(bytes));
+	}
+#elif defined(PHASH_SSE2)
+	for (; i + 2 <= pixelCount; i += 2, src += 8, dst += 2)
+	{
+		const auto gray = GrayValue2(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)));
+		dst[0]          = static_cast<uint8_t>(_mm_cvtsi128_si32(gray));
+		dst[1]          = static_cast<uint8_t>(_mm_cvtsi128_si32(_mm_srli_si128(gray, 4)));
+	}
+#endif
+
+	for (; i < pixelCount; ++i, src += 4, ++dst)
+		*dst = RoundGray(GrayValue(src));
+}
+
+uint64_t Compute(const uint8_t* gray, const size_t stride, const int left, const int top, const int width, const int height) noexcept
+{
+	// nearest neighbour resize takes source pixel floor(i * size / 32), the mean filter is needed at those points only
+	std::array<std::array<int, MEAN_SIZE>, SIZE> columnTaps {};
+	for (int i = 0; i < SIZE; ++i)
+	{
+		const auto column = i * width / SIZE;
+		for (int d = 0; d < MEAN_SIZE; ++d)
+			columnTaps[i][d] = left + std::clamp(column + d - MEAN_DELTA, 0, width - 1);
+	}
+
+	// separable 7x7 box sums, integers are exact in float so the result equals the float convolution
+	std::array<std::array<float, SIZE>, SIZE> resized {};
+	for (int y = 0; y < SIZE; ++y)
+	{
+		const auto            row = y * height / SIZE;
+		std::array<int, SIZE> sums {};
+		for (int d = 0; d < MEAN_SIZE; ++d)
+		{
+			const auto* line = gray + static_cast<size_t>(top + std::clamp(row + d - MEAN_DELTA, 0, height - 1)) * stride;
+			for (int x = 0; x < SIZE; ++x)
+			{
+				const auto& taps = columnTaps[x];
+				sums[x] += line[taps[0]] + line[taps[1]] + line[taps[2]] + line[taps[3]] + line[taps[4]] + line[taps[5]] + line[taps[6]];
+			}
+		}
+		std::ranges::transform(sums, resized[y].begin(), [](const int value) {
+			return static_cast<float>(value);
+		});
+	}
+
+	// rows 1..8 of DCT * resized, float products accumulated in double as the CImg matrix product does
+	std::array<std::array<float, SIZE>, BLOCK> partial {};
+	for (int u = 0; u < BLOCK; ++u)
+	{
+		const auto& dct = DCT[u + 1];
+		for (int x = 0; x < SIZE; ++x)
+		{
+			double value = 0;
+			for (int k = 0; k < SIZE; ++k)
+				value += dct[k] * resized[k][x];
+			partial[u][x] = static_cast<float>(value);
+		}
+	}
+
+	// columns 1..8 of partial * DCT^T
+	std::array<float, BLOCK * BLOCK> block {};
+	for (int u = 0; u < BLOCK; ++u)
+	{
+		for (int v = 0; v < BLOCK; ++v)
+		{
+			const auto& dct   = DCT[v + 1];
+			double      value = 0;
+			for (int k = 0; k < SIZE; ++k)
+				value += partial[u][k] * dct[k];
+			block[static_cast<size_t>(u * BLOCK + v)] = static_cast<float>(value);
+		}
+	}
+
+	const auto median = Median(block);
+	return std::accumulate(block.cbegin(), block.cend(), uint64_t { 0 }, [median](const uint64_t init, const float value) {
+		return init << 1 | (value > median ? 1 : 0);
+	});
+}
+
+} // namespace HomeCompa::Util::PHash
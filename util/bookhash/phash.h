@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HomeCompa::Util::PHash
+{
+
+/// RGBA8888 to 8-bit luminance blended over white, same rounding as lround((0.299r + 0.587g + 0.114b) * a / 255 + 255 - a)
+void RgbaToGray(const uint8_t* src, uint8_t* dst, size_t pixelCount) noexcept;
+
+/// pHash of the gray image region: 7x7 mean filter with clamped borders, nearest 32x32 resize, DCT, 8x8 low frequencies against their median.
+/// Only the 32x32 samples and the 8x8 DCT block are computed.
+uint64_t Compute(const uint8_t* gray, size_t stride, int left, int top, int width, int height) noexcept;
+
+}
@@ -0,0 +1,158 @@
+#include "phashindex.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <tuple>
+
+using namespace HomeCompa::Util;
+
+namespace
+{
+
+constexpr int    BLOCK_COUNT       = 4;
+constexpr int    BLOCK_BITS        = 64 / BLOCK_COUNT;
+constexpr size_t BUCKET_COUNT      = size_t { 1 } << BLOCK_BITS;
+constexpr size_t LINEAR_SCAN_LIMIT = size_t { 1 } << 16; // a popcount scan is faster than the bucket probes up to here
+
+uint16_t GetBlock(const uint64_t pHash, const int block) noexcept
+{
+	return static_cast<uint16_t>(pHash >> (block * BLOCK_BITS));
+}
+
+/// calls f for every 16-bit value within the distance of the value, Gosper's hack per bit count
+template <typename F>
+void ForEachNeighbour(const uint16_t value, const int maxDistance, F&& f)
+{
+	for (int bits = 0; bits <= std::min(maxDistance, BLOCK_BITS); ++bits)
+	{
+		for (uint32_t mask = (1u << bits) - 1; mask < BUCKET_COUNT;)
+		{
+			f(static_cast<uint16_t>(value ^ mask));
+			if (mask == 0)
+				break;
+
+			const auto lowest = mask & (0u - mask);
+			const auto ripple = mask + lowest;
+			mask              = (((ripple ^ mask) >> 2) / lowest) | ripple;
+		}
+	}
+}
+
+} // namespace
+
+struct PHashIndex::Impl
+{
+	using Bucket = std::vector<uint32_t>;
+	using Table  = std::vector<Bucket>;
+
+	std::vector<uint64_t>          hashes;
+	std::array<Table, BLOCK_COUNT> tables;
+
+	void AddToTables(const size_t id)
+	{
+		for (int block = 0; block < BLOCK_COUNT; ++block)
+			tables[static_cast<size_t>(block)][GetBlock(hashes[id], block)].push_back(static_cast<uint32_t>(id));
+	}
+
+	void BuildTables()
+	{
+		for (auto& table : tables)
+			table.resize(BUCKET_COUNT);
+
+		for (size_t id = 0, sz = hashes.size(); id < sz; ++id)
+			AddToTables(id);
+	}
+
+	bool HasTables() const noexcept
+	{
+		return !tables.front().empty();
+	}
+
+	void Scan(const uint64_t pHash, const int maxDistance, std::vector<Match>& result) const
+	{
+		for (size_t id = 0, sz = hashes.size(); id < sz; ++id)
+			if (const auto distance = std::popcount(pHash ^ hashes[id]); distance <= maxDistance)
+				result.emplace_back(id, distance);
+	}
+
+	void Probe(const uint64_t pHash, const int maxDistance, std::vector<Match>& result) const
+	{
+		const auto blockDistance = maxDistance / BLOCK_COUNT;
+		for (int block = 0; block < BLOCK_COUNT; ++block)
+		{
+			ForEachNeighbour(GetBlock(pHash, block), blockDistance, [&](const uint16_t key) {
+				for (const auto id : tables[static_cast<size_t>(block)][key])
+				{
+					const auto candidate = hashes[id];
+					const auto distance  = std::popcount(pHash ^ candidate);
+					if (distance > maxDistance)
+						continue;
+
+					// every match is reported by the first block it is found in
+					if (std::ranges::any_of(std::views::iota(0, block), [&](const int prev) {
+							return std::popcount(static_cast<unsigned>(GetBlock(pHash, prev) ^ GetBlock(candidate, prev))) <= blockDistance;
+						}))
+						continue;
+
+					result.emplace_back(id, distance);
+				}
+			});
+		}
+	}
+};
+
+PHashIndex::PHashIndex() = default;
+
+PHashIndex::~PHashIndex() = default;
+
+size_t PHashIndex::Add(const uint64_t pHash)
+{
+	const auto id = m_impl->hashes.size();
+	assert(id <= std::numeric_limits<uint32_t>::max());
+	m_impl->hashes.push_back(pHash);
+
+	if (m_impl->HasTables())
+		m_impl->AddToTables(id);
+	else if (m_impl->hashes.size() > LINEAR_SCAN_LIMIT)
+		m_impl->BuildTables();
+
+	return id;
+}
+
+void PHashIndex::Reserve(const size_t size)
+{
+	m_impl->hashes.reserve(size);
+}
+
+size_t PHashIndex::Size() const noexcept
+{
+	return m_impl->hashes.size();
+}
+
+uint64_t PHashIndex::Get(const size_t id) const noexcept
+{
+	assert(id < m_impl->hashes.size());
+	return m_impl->hashes[id];
+}
+
+std::vector<PHashIndex::Match> PHashIndex::Find(const uint64_t pHash, const int maxDistance) const
+{
+	assert(maxDistance >= 0);
+
+	std::vector<Match> result;
+	if (m_impl->HasTables() && maxDistance < 64)
+		m_impl->Probe(pHash, maxDistance, result);
+	else
+		m_impl->Scan(pHash, maxDistance, result);
+
+	std::ranges::sort(result, [](const Match& lhs, const Match& rhs) {
+		return std::tie(lhs.distance, lhs.id) < std::tie(rhs.distance, rhs.id);
+	});
+
+	return result;
+}
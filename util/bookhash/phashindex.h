@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "fnd/NonCopyMovable.h"
+#include "fnd/memory.h"
+
+#include "export/util.h"
+
+namespace HomeCompa::Util
+{
+
+/// Near-duplicate search over 64-bit pHashes, multi-index hashing on 4 16-bit blocks:
+/// if two hashes are within distance r, at least one of their blocks is within r / 4.
+/// Small indices are scanned linearly, the block tables are built once the index grows.
+class UTIL_EXPORT PHashIndex
+{
+	NON_COPY_MOVABLE(PHashIndex)
+
+public:
+	struct Match
+	{
+		size_t id;
+		int    distance;
+	};
+
+public:
+	PHashIndex();
+	~PHashIndex();
+
+public:
+	/// returns the id of the hash: ids are assigned sequentially from 0
+	size_t Add(uint64_t pHash);
+	void   Reserve(size_t size);
+
+	[[nodiscard]] size_t   Size() const noexcept;
+	[[nodiscard]] uint64_t Get(size_t id) const noexcept;
+
+	/// all the hashes within the Hamming distance, ordered by distance and id
+	[[nodiscard]] std::vector<Match> Find(uint64_t pHash, int maxDistance) const;
+
+private:
+	struct Impl;
+	PropagateConstPtr<Impl> m_impl;
+};
+
+} // namespace HomeCompa::Util
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cassert>
+#include <cstddef>
 #include <numbers>
 #include <vector>
 
@@ -12,17 +13,19 @@ using namespace HomeCompa::Util;
 namespace
 {
 
+constexpr int MAGNITUDE_MAX_SQUARED = 65280; // sqrt rounds to 255 from here on
+
 template <std::integral U, std::floating_point V>
 U Round(const V v)
 {
 	return static_cast<U>(std::min(std::llround(v), static_cast<long long>(std::numeric_limits<U>::max())));
 }
 
-std::vector<std::vector<double>> CreateGaussianFilter(const int row, const int column, const double sigmaIn)
+std::array<double, 9> CreateGaussianFilter(const int row, const int column, const double sigmaIn)
 {
-	assert((row & 1) && (column & 1));
+	assert(row == 3 && column == 3);
 
-	std::vector result(3, std::vector(3, -1.0));
+	std::array<double, 9> result {};
 
 	const auto constant = 2.0 * sigmaIn * sigmaIn;
 
@@ -31,197 +34,191 @@ std::vector<std::vector<double>> CreateGaussianFilter(const int row, const int c
 
 	for (int x = -row / 2; x <= row / 2; ++x)
 		for (int y = -column / 2; y <= column / 2; ++y)
-			sum += (result[x + row / 2][y + column / 2] = std::exp(-(x * x + y * y) / constant) / (std::numbers::pi * constant));
+			sum += (result[static_cast<size_t>((x + row / 2) * column + y + column / 2)] = std::exp(-(x * x + y * y) / constant) / (std::numbers::pi * constant));
 
 	// Normalize the Filter
-	for (int i = 0; i < row; ++i)
-		for (int j = 0; j < column; ++j)
-			result[i][j] /= sum;
+	for (auto& value : result)
+		value /= sum;
 
 	return result;
 }
 
-template <typename T>
-CImg<T> ApplyFilter(CImg<T> src, const std::vector<std::vector<double>>& filterIn)
+// Round<unsigned char>(sqrt(x * x + y * y)) for every possible squared magnitude below the saturation
+std::vector<uint8_t> CreateMagnitudeTable()
 {
-	const auto size = static_cast<unsigned int>(filterIn.size()) / 2;
-	CImg<T>    result(src._width - 2 * size, src._height - 2 * size);
-	for (auto i = size; i < src._width - size; ++i)
-	{
-		for (auto j = size; j < src._height - size; ++j)
-		{
-			double sum = 0;
+	std::vector<uint8_t> result(MAGNITUDE_MAX_SQUARED + 1);
+	for (int i = 0; i <= MAGNITUDE_MAX_SQUARED; ++i)
+		result[static_cast<size_t>(i)] = Round<uint8_t>(std::sqrt(static_cast<double>(i)));
+	return result;
+}
 
-			for (auto x = 0U, sz = static_cast<unsigned int>(filterIn.size()); x < sz; ++x)
-				for (auto y = 0U; y < sz; ++y)
-					sum += filterIn[x][y] * src(i + y - size, j + x - size);
+const std::vector<uint8_t> MAGNITUDE = CreateMagnitudeTable();
 
-			result(i - size, j - size) = Round<T>(sum);
-		}
+/// per thread buffers reused across images
+struct Scratch
+{
+	std::vector<uint8_t> gaussian;
+	std::vector<uint8_t> magnitude;
+	std::vector<int16_t> sobelX;
+	std::vector<int16_t> sobelY;
+	std::vector<uint8_t> suppressed;
+
+	static Scratch& Get()
+	{
+		thread_local Scratch scratch;
+		return scratch;
 	}
+};
 
-	return result;
+// lround for non-negative values without the libm call, the fraction is exact
+uint8_t RoundPositive(const double value) noexcept
+{
+	const auto integral = static_cast<long long>(value);
+	return static_cast<uint8_t>(std::min(integral + (value - static_cast<double>(integral) >= 0.5 ? 1 : 0), 255LL));
 }
 
-std::pair<CImg<unsigned char>, CImg<float>> ApplySobel(const CImg<unsigned char>& src)
+// 3x3 filter with the same accumulation order as the 2D one: every pixel sum is the same double
+void ApplyFilter(const uint8_t* src, const size_t width, const size_t height, const std::array<double, 9>& filter, uint8_t* dst)
 {
-	static constexpr std::array<std::array<double, 3>, 3>
-		xSobelFilter = {{
-			{ -1.0, 0, 1.0 },
-			{ -2.0, 0, 2.0 },
-			{ -1.0, 0, 1.0 },
-		}},
-		ySobelFilter = {{
-			{ 1.0, 2.0, 1.0 },
-			{ 0, 0, 0 },
-			{ -1.0, -2.0, -1.0 },
-		}};
-	static_assert(xSobelFilter.size() == ySobelFilter.size());
-
-	static constexpr auto size = static_cast<unsigned int>(xSobelFilter.size()) / 2;
-
-	CImg<unsigned char> sFiltered(src._width - 2 * size, src._height - 2 * size);
-	CImg<float>         angles(src._width - 2 * size, src._height - 2 * size);
-
-	for (auto i = size; i < src._height - size; ++i)
+	const auto dstWidth = width - 2;
+	for (size_t y = 0; y < height - 2; ++y)
 	{
-		for (auto j = size; j < src._width - size; ++j)
+		const uint8_t* rows[] { src + y * width, src + (y + 1) * width, src + (y + 2) * width };
+		auto*          out = dst + y * dstWidth;
+		for (size_t x = 0; x < dstWidth; ++x)
 		{
-			auto sumX = 0.0, sumY = 0.0;
-
-			for (auto x = 0U; x < xSobelFilter.size(); ++x)
-				for (auto y = 0U; y < ySobelFilter.size(); ++y)
-				{
-					sumX += xSobelFilter[x][y] * src(j + y - size, i + x - size);
-					sumY += ySobelFilter[x][y] * src(j + y - size, i + x - size);
-				}
+			double sum = 0;
+			for (size_t r = 0; r < 3; ++r)
+				for (size_t c = 0; c < 3; ++c)
+					sum += filter[r * 3 + c] * rows[r][x + c];
 
-			sFiltered(j - size, i - size) = Round<unsigned char>(std::sqrt(sumX * sumX + sumY * sumY));
-			angles(j - size, i - size)    = std::abs(sumX) <= std::numeric_limits<double>::epsilon() ? 90.0f : static_cast<float>(std::atan(sumY / sumX));
+			out[x] = RoundPositive(sum);
 		}
 	}
-
-	return std::make_pair(std::move(sFiltered), std::move(angles));
 }
 
-CImg<unsigned char> ApplyThreshold(const CImg<unsigned char>& src, int low, int high)
+// integer Sobel, the gradients are exact so the magnitude comes from the squared one through the table
+void ApplySobel(const uint8_t* src, const size_t width, const size_t height, uint8_t* magnitude, int16_t* sobelX, int16_t* sobelY)
 {
-	if (low > 255)
-		low = 255;
-	if (high > 255)
-		high = 255;
-
-	CImg<unsigned char> result(src._width, src._height);
-
-	for (auto i = 0; i < static_cast<int>(src._width); ++i)
+	const auto dstWidth = width - 2;
+	for (size_t y = 0; y < height - 2; ++y)
 	{
-		for (auto j = 0; j < static_cast<int>(src._height); ++j)
+		const auto* r0 = src + y * width;
+		const auto* r1 = r0 + width;
+		const auto* r2 = r1 + width;
+
+		const auto offset = y * dstWidth;
+		for (size_t x = 0; x < dstWidth; ++x)
 		{
-			result(i, j) = src(i, j);
-			if (result(i, j) > high)
-				result(i, j) = 255;
-			else if (result(i, j) < low)
-				result(i, j) = 0;
-			else
-			{
-				bool anyHigh    = false;
-				bool anyBetween = false;
-				for (auto x = i - 1; x < i + 2; ++x)
-				{
-					for (auto y = j - 1; y < j + 2; ++y)
-					{
-						//Wang Note: a missing "x" in Hasan's code.
-						if (x < 0 || y < 0 || x >= static_cast<int>(result._width) || y >= static_cast<int>(result._height)) //Out of bounds
-							continue;
-
-						if (src(x, y) > high)
-						{
-							result(i, j) = 255;
-							anyHigh      = true;
-							break;
-						}
-
-						if (src(x, y) <= high && src(x, y) >= low)
-							anyBetween = true;
-					}
-					if (anyHigh)
-						break;
-				}
-				if (!anyHigh && anyBetween)
-					for (auto x = i - 2; x < i + 3; ++x)
-					{
-						for (auto y = j - 1; y < j + 3; ++y)
-						{
-							if (x < 0 || y < 0 || x >= static_cast<int>(result._width) || y >= static_cast<int>(result._height)) //Out of bounds
-								continue;
-
-							if (src(x, y) > high)
-							{
-								result(i, j) = 255;
-								anyHigh      = true;
-								break;
-							}
-						}
-						if (anyHigh)
-							break;
-					}
-				if (!anyHigh)
-					result(i, j) = 0;
-			}
+			const auto gx = (r0[x + 2] - r0[x]) + 2 * (r1[x + 2] - r1[x]) + (r2[x + 2] - r2[x]);
+			const auto gy = (r0[x] + 2 * r0[x + 1] + r0[x + 2]) - (r2[x] + 2 * r2[x + 1] + r2[x + 2]);
+			const auto m2 = gx * gx + gy * gy;
+
+			magnitude[offset + x] = m2 >= MAGNITUDE_MAX_SQUARED ? 255 : MAGNITUDE[static_cast<size_t>(m2)];
+			sobelX[offset + x]    = static_cast<int16_t>(gx);
+			sobelY[offset + x]    = static_cast<int16_t>(gy);
 		}
 	}
-
-	return result;
 }
 
-CImg<unsigned char> nonMaxSupp(const CImg<unsigned char>& sFiltered, const CImg<float>& angles)
+// the angle is only needed where the magnitude is not zero: zero is never suppressed further
+void NonMaxSupp(const uint8_t* sFiltered, const int16_t* sobelX, const int16_t* sobelY, const size_t width, const size_t height, uint8_t* result)
 {
-	auto result = CImg<unsigned char>(sFiltered._width - 2, sFiltered._height - 2);
-	for (auto i = 1U; i < sFiltered._width - 1; ++i)
+	const auto dstWidth = width - 2;
+	for (size_t j = 1; j < height - 1; ++j)
 	{
-		for (auto j = 1U; j < sFiltered._height - 1; ++j)
+		for (size_t i = 1; i < width - 1; ++i)
 		{
-			float Tangent = angles(i, j) * 57.296f;
-			// cout << Tangent << ' ';
-			result(i - 1, j - 1) = sFiltered(i, j);
+			const auto  index = j * width + i;
+			const auto* p     = sFiltered + index;
+			auto&       out   = result[(j - 1) * dstWidth + i - 1];
+
+			out = *p;
+			if (!out)
+				continue;
+
+			const auto  sumX    = sobelX[index];
+			const auto  angle   = sumX == 0 ? 90.0f : static_cast<float>(std::atan(static_cast<double>(sobelY[index]) / static_cast<double>(sumX)));
+			const float Tangent = angle * 57.296f;
+
 			//Horizontal Edge
 			if (-22.5 < Tangent && Tangent <= 22.5)
 			{
-				if ((sFiltered(i, j) < sFiltered(i + 1, j)) || (sFiltered(i, j) < sFiltered(i - 1, j)))
-					result(i - 1, j - 1) = 0;
+				if (*p < p[1] || *p < p[-1])
+					out = 0;
 			}
 			//Vertical Edge
 			if (((-112.5 < Tangent) && (Tangent <= -67.5)) || ((67.5 < Tangent) && (Tangent <= 112.5)))
 			{
-				if ((sFiltered(i, j) < sFiltered(i, j + 1)) || (sFiltered(i, j) < sFiltered(i, j - 1)))
-					result(i - 1, j - 1) = 0;
+				if (*p < p[width] || *p < p[-static_cast<std::ptrdiff_t>(width)])
+					out = 0;
 			}
 
 			//-45 Degree Edge
 			if (((-67.5 < Tangent) && (Tangent <= -22.5)) || ((112.5 < Tangent) && (Tangent <= 157.5)))
 			{
-				if ((sFiltered(i, j) < sFiltered(i + 1, j + 1)) || (sFiltered(i, j) < sFiltered(i - 1, j - 1)))
-					result(i - 1, j - 1) = 0;
+				if (*p < p[width + 1] || *p < p[-static_cast<std::ptrdiff_t>(width) - 1])
+					out = 0;
 			}
 
 			//45 Degree Edge
 			if (((-157.5 < Tangent) && (Tangent <= -112.5)) || ((22.5 < Tangent) && (Tangent <= 67.5)))
 			{
-				if ((sFiltered(i, j) < sFiltered(i - 1, j + 1)) || (sFiltered(i, j) < sFiltered(i + 1, j - 1)))
-					result(i - 1, j - 1) = 0;
+				if (*p < p[width - 1] || *p < p[-static_cast<std::ptrdiff_t>(width) + 1])
+					out = 0;
 			}
 		}
-		// cout << '\n';
 	}
+}
 
-	return result;
+// hysteresis of a single pixel, src(x, y) is src[y * width + x]
+bool IsEdge(const uint8_t* src, const int width, const int height, const int i, const int j, const int low, const int high)
+{
+	const auto value = src[j * width + i];
+	if (value > high)
+		return true;
+	if (value < low)
+		return false;
+
+	bool anyBetween = false;
+	for (auto x = i - 1; x < i + 2; ++x)
+	{
+		for (auto y = j - 1; y < j + 2; ++y)
+		{
+			//Wang Note: a missing "x" in Hasan's code.
+			if (x < 0 || y < 0 || x >= width || y >= height) //Out of bounds
+				continue;
+
+			const auto neighbour = src[y * width + x];
+			if (neighbour > high)
+				return true;
+
+			if (neighbour <= high && neighbour >= low)
+				anyBetween = true;
+		}
+	}
+
+	if (!anyBetween)
+		return false;
+
+	for (auto x = i - 2; x < i + 3; ++x)
+		for (auto y = j - 1; y < j + 3; ++y)
+		{
+			if (x < 0 || y < 0 || x >= width || y >= height) //Out of bounds
+				continue;
+
+			if (src[y * width + x] > high)
+				return true;
+		}
+
+	return false;
 }
 
 } // namespace
 
 Canny::Canny(const int gaussianFilterSize, const double gaussianSigma, const int thresholdLow, const int thresholdHigh)
-	: m_thresholdLow { thresholdLow }
-	, m_thresholdHigh { thresholdHigh }
+	: m_thresholdLow { std::min(thresholdLow, 255) }
+	, m_thresholdHigh { std::min(thresholdHigh, 255) }
 	, m_gaussianFilter { CreateGaussianFilter(gaussianFilterSize, gaussianFilterSize, gaussianSigma) }
 {
 }
@@ -231,31 +228,54 @@ Canny::Rect Canny::Process(const CImg<unsigned char>& img) const
 	if (std::min(img.width(), img.height()) < 20)
 		return Rect {};
 
-	const auto gFiltered           = ApplyFilter(img, m_gaussianFilter);
-	const auto [sFiltered, angles] = ApplySobel(gFiltered);
-	const auto nonMaxSupped        = nonMaxSupp(sFiltered, angles);
-	const auto threshold           = ApplyThreshold(nonMaxSupped, m_thresholdLow, m_thresholdHigh);
-
-	Rect rect { .top = 0, .left = 0, .bottom = static_cast<int16_t>(threshold._height), .right = static_cast<int16_t>(threshold._width) };
-	for (const auto* data = threshold.data(); rect.top < rect.bottom; ++rect.top, data += threshold._width)
-		if (memchr(data, 255, threshold._width))
-			break;
-
-	for (const auto* data = threshold.data() + static_cast<size_t>(threshold._width) * (threshold._height - 1); rect.top < rect.bottom; --rect.bottom, data -= threshold._width)
-		if (memchr(data, 255, threshold._width))
-			break;
-
-	for (; rect.left < rect.right; ++rect.left)
-		for (auto i = 0U; i < threshold._height; ++i)
-			if (threshold(rect.left, i) == 255)
-				goto leftFound;
-leftFound:
-
-	for (; rect.left < rect.right; --rect.right)
-		for (auto i = 0U; i < threshold._height; ++i)
-			if (threshold(rect.right - 1, i) == 255)
-				goto rightFound;
-rightFound:
-
-	return rect;
+	auto& scratch = Scratch::Get();
+
+	const auto width  = static_cast<size_t>(img.width());
+	const auto height = static_cast<size_t>(img.height());
+
+	scratch.gaussian.resize((width - 2) * (height - 2));
+	ApplyFilter(img.data(), width, height, m_gaussianFilter, scratch.gaussian.data());
+
+	const auto sobelSize = (width - 4) * (height - 4);
+	scratch.magnitude.resize(sobelSize);
+	scratch.sobelX.resize(sobelSize);
+	scratch.sobelY.resize(sobelSize);
+	ApplySobel(scratch.gaussian.data(), width - 2, height - 2, scratch.magnitude.data(), scratch.sobelX.data(), scratch.sobelY.data());
+
+	scratch.suppressed.resize((width - 6) * (height - 6));
+	NonMaxSupp(scratch.magnitude.data(), scratch.sobelX.data(), scratch.sobelY.data(), width - 4, height - 4, scratch.suppressed.data());
+
+	// the threshold image itself is not needed, only the bounding box of its edge pixels
+	const auto thresholdWidth  = static_cast<int>(width - 6);
+	const auto thresholdHeight = static_cast<int>(height - 6);
+
+	const auto isEdge = [&](const int i, const int j) {
+		return IsEdge(scratch.suppressed.data(), thresholdWidth, thresholdHeight, i, j, m_thresholdLow, m_thresholdHigh);
+	};
+
+	// every row is scanned from both ends up to its outermost edge pixels, the middle does not change the box
+	int top = thresholdHeight, bottom = -1, left = thresholdWidth, right = -1;
+	for (int j = 0; j < thresholdHeight; ++j)
+	{
+		int first = 0;
+		while (first < thresholdWidth && !isEdge(first, j))
+			++first;
+
+		if (first == thresholdWidth)
+			continue;
+
+		int last = thresholdWidth - 1;
+		while (last > first && last > right && !isEdge(last, j))
+			--last;
+
+		top    = std::min(top, j);
+		bottom = j;
+		left   = std::min(left, first);
+		right  = std::max(right, last);
+	}
+
+	if (bottom < 0)
+		return Rect { .top = static_cast<int16_t>(thresholdHeight), .left = static_cast<int16_t>(thresholdWidth), .bottom = static_cast<int16_t>(thresholdHeight), .right = static_cast<int16_t>(thresholdWidth) };
+
+	return Rect { .top = static_cast<int16_t>(top), .left = static_cast<int16_t>(left), .bottom = static_cast<int16_t>(bottom + 1), .right = static_cast<int16_t>(right + 1) };
 }
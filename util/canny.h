@@ -2,7 +2,7 @@
 
 #include <CImg.h>
 
-#include <vector>
+#include <array>
 
 namespace HomeCompa::Util
 {
@@ -32,7 +32,7 @@ public:
 private:
 	const int m_thresholdLow, m_thresholdHigh;
 
-	const std::vector<std::vector<double>> m_gaussianFilter;
+	const std::array<double, 9> m_gaussianFilter;
 };
 
 } // namespace HomeCompa::Util
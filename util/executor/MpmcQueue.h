@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <optional>
+
+namespace HomeCompa::Util
+{
+
+// Bounded multi-producer multi-consumer ring buffer (D. Vyukov's algorithm).
+// Every cell carries a sequence number, so producers and consumers only contend on their own cursor with a single CAS.
+template <typename T>
+class MpmcQueue
+{
+	static constexpr size_t CACHE_LINE = 64;
+
+	struct Cell
+	{
+		std::atomic_size_t sequence;
+		std::optional<T>   data;
+	};
+
+public:
+	explicit MpmcQueue(const size_t capacity)
+		: m_mask { std::bit_ceil(std::max(capacity, size_t { 2 })) - 1 }
+		, m_cells { std::make_unique<Cell[]>(m_mask + 1) }
+	{
+		for (size_t i = 0; i <= m_mask; ++i)
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	size_t capacity() const noexcept
+	{
+		return m_mask + 1;
+	}
+
+	bool try_push(T& value)
+	{
+		auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			auto&      cell = m_cells[pos & m_mask];
+			const auto seq  = cell.sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+			if (diff == 0)
+			{
+				if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					cell.data.emplace(std::move(value));
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos = m_enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	std::optional<T> try_pop()
+	{
+		auto pos = m_dequeuePos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			auto&      cell = m_cells[pos & m_mask];
+			const auto seq  = cell.sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos + 1);
+			if (diff == 0)
+			{
+				if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					std::optional<T> result(std::move(cell.data));
+					cell.data.reset();
+					cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+					return result;
+				}
+			}
+			else if (diff < 0)
+			{
+				return std::nullopt;
+			}
+			else
+			{
+				pos = m_dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+private:
+	const size_t            m_mask;
+	std::unique_ptr<Cell[]> m_cells;
+
+	alignas(CACHE_LINE) std::atomic_size_t m_enqueuePos { 0 };
+	alignas(CACHE_LINE) std::atomic_size_t m_dequeuePos { 0 };
+};
+
+} // namespace HomeCompa::Util
@@ -1,20 +1,91 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <ranges>
 #include <thread>
 
+#include "fnd/MoveOnlyFunction.h"
+
+#include "MpmcQueue.h"
+
 namespace HomeCompa::Util
 {
 
+namespace ThreadPoolDetail
+{
+
+// Futex-backed wakeup that only enters the kernel when somebody actually sleeps.
+class Signal
+{
+	static constexpr int SPIN_COUNT = 32;
+
+public:
+	template <typename Predicate>
+	void wait(Predicate predicate)
+	{
+		for (int i = 0; i < SPIN_COUNT; ++i)
+		{
+			if (predicate())
+				return;
+			std::this_thread::yield();
+		}
+
+		while (!predicate())
+		{
+			const auto epoch = m_epoch.load();
+			++m_waiters;
+			// pairs with the fence in notify: either the notifier sees the waiter or the waiter sees the published state
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!predicate())
+				m_epoch.wait(epoch);
+			--m_waiters;
+		}
+	}
+
+	void notify_one()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!m_waiters.load())
+			return;
+
+		++m_epoch;
+		m_epoch.notify_one();
+	}
+
+	void notify_all()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!m_waiters.load())
+			return;
+
+		++m_epoch;
+		m_epoch.notify_all();
+	}
+
+	void wake_all()
+	{
+		++m_epoch;
+		m_epoch.notify_all();
+	}
+
+private:
+	std::atomic_uint32_t m_epoch { 0 };
+	std::atomic_int      m_waiters { 0 };
+};
+
+} // namespace ThreadPoolDetail
+
 template <typename T = size_t>
 class ThreadPool
 {
 public:
-	using Task = std::function<void(T&, const std::stop_token&)>;
+	using Task = MoveOnlyFunction<void(T&, const std::stop_token&)>;
 
 public:
 	struct Initializer
@@ -24,12 +95,22 @@ public:
 		std::function<T(size_t)> contextGetter { [](size_t) {
 			return T {};
 		} };
+
+		// lock-free mode: tasks go through two bounded ring buffers (high priority and normal), queue size is limited by lockFreeCapacity too
+		bool   lockFree { false };
+		size_t lockFreeCapacity { 1024 };
 	};
 
 public:
 	explicit ThreadPool(const Initializer& initializer = {})
-		: m_maxQueueSize { initializer.maxQueueSize }
+		: m_maxQueueSize { initializer.lockFree ? std::min(initializer.maxQueueSize, std::max(initializer.lockFreeCapacity, size_t { 1 })) : initializer.maxQueueSize }
 	{
+		if (initializer.lockFree)
+		{
+			m_priorityLane = std::make_unique<MpmcQueue<Task>>(m_maxQueueSize);
+			m_normalLane   = std::make_unique<MpmcQueue<Task>>(m_maxQueueSize);
+		}
+
 		m_contexts.reserve(initializer.threadCount);
 		std::ranges::transform(std::views::iota(decltype(initializer.threadCount) { 0 }, initializer.threadCount), std::back_inserter(m_contexts), [&](const auto n) {
 			return initializer.contextGetter(n);
@@ -42,9 +123,12 @@ public:
 
 	void enqueue(Task task, const bool highPriority = false)
 	{
+		if (m_normalLane)
+			return enqueueLockFree(std::move(task), highPriority);
+
 		{
 			std::unique_lock lock(m_tasksGuard);
-			m_condition.wait(lock, [this] {
+			m_spaceCondition.wait(lock, [this] {
 				return m_tasks.size() < m_maxQueueSize;
 			});
 			if (highPriority)
@@ -56,11 +140,53 @@ public:
 		m_condition.notify_one();
 	}
 
+	/// enqueues the whole range taking the lock once per queue fill and waking the workers once per fill
+	template <std::ranges::input_range R>
+	void enqueue_bulk(R&& tasks, const bool highPriority = false)
+	{
+		auto       it  = std::ranges::begin(tasks);
+		const auto end = std::ranges::end(tasks);
+
+		if (m_normalLane)
+		{
+			for (; it != end; ++it)
+				pushLockFree(Task(std::move(*it)), highPriority);
+			m_taskSignal.notify_all();
+			return;
+		}
+
+		while (it != end)
+		{
+			{
+				std::unique_lock lock(m_tasksGuard);
+				m_spaceCondition.wait(lock, [this] {
+					return m_tasks.size() < m_maxQueueSize;
+				});
+
+				// high priority tasks are placed in front of the queue keeping their relative order
+				for (size_t n = 0; it != end && m_tasks.size() < m_maxQueueSize; ++it, ++n)
+					if (highPriority)
+						m_tasks.emplace(std::next(m_tasks.begin(), static_cast<ptrdiff_t>(n)), std::move(*it));
+					else
+						m_tasks.emplace_back(std::move(*it));
+			}
+
+			m_condition.notify_all();
+		}
+	}
+
 	std::vector<T> wait()
 	{
+		if (m_normalLane)
+		{
+			m_spaceSignal.wait([this] {
+				return m_queued.load() == 0;
+			});
+		}
+		else
 		{
 			std::unique_lock lock(m_tasksGuard);
-			m_condition.wait(lock, [this] {
+			m_spaceCondition.wait(lock, [this] {
 				return m_tasks.empty();
 			});
 		}
@@ -72,10 +198,43 @@ public:
 	}
 
 private:
+	void enqueueLockFree(Task task, const bool highPriority)
+	{
+		pushLockFree(std::move(task), highPriority);
+		m_taskSignal.notify_one();
+	}
+
+	void pushLockFree(Task task, const bool highPriority)
+	{
+		// reserve a place first so that maxQueueSize stays an exact bound across both lanes
+		for (auto queued = m_queued.load();;)
+		{
+			if (queued >= m_maxQueueSize)
+			{
+				m_taskSignal.notify_all();
+				m_spaceSignal.wait([this] {
+					return m_queued.load() < m_maxQueueSize;
+				});
+				queued = m_queued.load();
+				continue;
+			}
+
+			if (m_queued.compare_exchange_weak(queued, queued + 1))
+				break;
+		}
+
+		auto& lane = highPriority ? *m_priorityLane : *m_normalLane;
+		while (!lane.try_push(task))
+			std::this_thread::yield();
+	}
+
 	Task getTask(const std::stop_token& stop)
 	{
+		if (m_normalLane)
+			return getTaskLockFree(stop);
+
 		auto task = getTaskImpl(stop);
-		m_condition.notify_all();
+		m_spaceCondition.notify_all();
 
 		return task;
 	}
@@ -94,8 +253,30 @@ private:
 		return task;
 	}
 
+	Task getTaskLockFree(const std::stop_token& stop)
+	{
+		std::optional<Task> task;
+		m_taskSignal.wait([&] {
+			return (task = m_priorityLane->try_pop()) || (task = m_normalLane->try_pop()) || stop.stop_requested();
+		});
+
+		if (!task)
+			return {};
+
+		--m_queued;
+		m_spaceSignal.notify_all();
+
+		return std::move(*task);
+	}
+
 	void work(T& t, const std::stop_token stop)
 	{
+		std::optional<std::stop_callback<std::function<void()>>> stopCallback;
+		if (m_normalLane)
+			stopCallback.emplace(stop, [this] {
+				m_taskSignal.wake_all();
+			});
+
 		while (!stop.stop_requested())
 			if (const auto task = getTask(stop))
 				task(t, stop);
@@ -106,8 +287,16 @@ private:
 	std::deque<Task>            m_tasks;
 	std::mutex                  m_tasksGuard;
 	std::condition_variable_any m_condition;
-	std::vector<T>              m_contexts;
-	std::vector<std::jthread>   m_threads;
+	std::condition_variable_any m_spaceCondition;
+
+	std::unique_ptr<MpmcQueue<Task>> m_priorityLane;
+	std::unique_ptr<MpmcQueue<Task>> m_normalLane;
+	std::atomic_size_t               m_queued { 0 };
+	ThreadPoolDetail::Signal         m_taskSignal;
+	ThreadPoolDetail::Signal         m_spaceSignal;
+
+	std::vector<T>            m_contexts;
+	std::vector<std::jthread> m_threads;
 };
 
 } // namespace HomeCompa::Util
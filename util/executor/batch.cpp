@@ -0,0 +1,115 @@
+#include "batch.h"
+
+#include <atomic>
+#include <memory>
+
+#include "log.h"
+
+namespace HomeCompa::Util::ExecutorPrivate
+{
+
+namespace
+{
+
+struct Batch
+{
+	std::vector<IExecutor::TaskResult> results;
+	std::vector<size_t>                ids;
+	std::atomic_size_t                 remaining;
+	IExecutor::BatchResult             onBatchFinished;
+
+	Batch(const size_t size, IExecutor::BatchResult onBatchFinished)
+		: results(size)
+		, ids(size)
+		, remaining { size }
+		, onBatchFinished { std::move(onBatchFinished) }
+	{
+	}
+
+	void Finish() const
+	{
+		for (size_t i = 0, sz = results.size(); i < sz; ++i)
+			if (results[i])
+				results[i](ids[i]);
+
+		if (onBatchFinished)
+			onBatchFinished();
+	}
+};
+
+}
+
+std::vector<IExecutor::Task> CreateBatch(const std::span<IExecutor::Task> tasks, IExecutor::BatchResult onBatchFinished)
+{
+	if (tasks.empty())
+	{
+		std::vector<IExecutor::Task> result(1);
+		result.front().name         = "empty batch";
+		result.front().displaceable = false;
+		result.front().task = [onBatchFinished = std::move(onBatchFinished)]() mutable -> IExecutor::TaskResult {
+			return [onBatchFinished = std::move(onBatchFinished)](size_t) {
+				if (onBatchFinished)
+					onBatchFinished();
+			};
+		};
+		return result;
+	}
+
+	auto batch = std::make_shared<Batch>(tasks.size(), std::move(onBatchFinished));
+
+	std::vector<IExecutor::Task> result;
+	result.reserve(tasks.size());
+	for (size_t i = 0, sz = tasks.size(); i < sz; ++i)
+	{
+		auto& task    = tasks[i];
+		batch->ids[i] = task.id;
+		result.push_back({
+			.name = task.name,
+			.task = [batch, i, name = task.name, task = std::move(task.task)]() -> IExecutor::TaskResult {
+				try
+				{
+					batch->results[i] = task();
+				}
+				catch (const std::exception& ex)
+				{
+					PLOGE << name << ": " << ex.what();
+				}
+				catch (...)
+				{
+					PLOGE << name << " failed";
+				}
+
+				if (--batch->remaining)
+					return {};
+
+				return [batch](size_t) {
+					batch->Finish();
+				};
+			},
+			.id = task.id,
+			.displaceable = false,
+		});
+	}
+
+	return result;
+}
+
+size_t Displace(std::multimap<int, IExecutor::Task>& tasks, const int priority)
+{
+	size_t count = 0;
+	for (auto [it, end] = tasks.equal_range(priority); it != end;)
+	{
+		if (!it->second.displaceable)
+		{
+			++it;
+			continue;
+		}
+
+		it = tasks.erase(it);
+		++count;
+	}
+
+	return count;
+}
+
+}
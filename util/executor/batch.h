@@ -0,0 +1,18 @@
+#pragma once
+
+#include <map>
+#include <span>
+#include <vector>
+
+#include "IExecutor.h"
+
+namespace HomeCompa::Util::ExecutorPrivate
+{
+
+/// wraps the batch tasks so that only the last finished one returns a result: it calls every task result and then onBatchFinished
+std::vector<IExecutor::Task> CreateBatch(std::span<IExecutor::Task> tasks, IExecutor::BatchResult onBatchFinished);
+
+/// erases the queued tasks of the priority except the batch ones, returns the number erased
+size_t Displace(std::multimap<int, IExecutor::Task>& tasks, int priority);
+
+}
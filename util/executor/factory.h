@@ -10,9 +10,11 @@ namespace HomeCompa::Util
 
 #define UTIL_EXECUTOR_IMPLS_XMACRO \
 	UTIL_EXECUTOR_IMPL(Sync)       \
-	UTIL_EXECUTOR_IMPL(Async)
+	UTIL_EXECUTOR_IMPL(Async)      \
+	UTIL_EXECUTOR_IMPL(Stealing)
 
 class IExecutor;
+class ExecutorMetrics;
 enum class ExecutorImpl
 {
 #define UTIL_EXECUTOR_IMPL(NAME) NAME,
@@ -31,6 +33,9 @@ struct ExecutorInitializer
 	} };
 	std::function<void()> onDestroy { [] {
 	} };
+
+	/// optional, collects queue wait and run times of the executed tasks
+	std::shared_ptr<ExecutorMetrics> metrics;
 };
 
 }
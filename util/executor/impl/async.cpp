@@ -8,7 +8,9 @@
 
 #include "fnd/NonCopyMovable.h"
 
+#include "executor/batch.h"
 #include "executor/factory.h"
+#include "executor/metrics.h"
 
 #include "FunctorExecutionForwarder.h"
 #include "IExecutor.h"
@@ -72,12 +74,15 @@ private: // Util::IExecutor
 	size_t operator()(Task&& task, int priority, const bool displace) override
 	{
 		const auto id = task.id;
+		if (m_initializer.metrics)
+			task = m_initializer.metrics->Instrument(std::move(task));
+
 		{
 			std::lock_guard lock(m_tasksGuard);
 			if (!priority)
 				priority = 1024;
 			else if (displace)
-				m_tasks.erase(priority);
+				ExecutorPrivate::Displace(m_tasks, priority);
 
 			m_tasks.emplace(priority, std::move(task));
 			m_condition.notify_one();
@@ -86,6 +91,24 @@ private: // Util::IExecutor
 		return id;
 	}
 
+	void operator()(const std::span<Task> tasks, BatchResult onBatchFinished, int priority) override
+	{
+		auto batch = CreateBatch(tasks, std::move(onBatchFinished));
+		if (m_initializer.metrics)
+			for (auto& task : batch)
+				task = m_initializer.metrics->Instrument(std::move(task));
+
+		{
+			std::lock_guard lock(m_tasksGuard);
+			if (!priority)
+				priority = 1024;
+
+			for (auto& task : batch)
+				m_tasks.emplace(priority, std::move(task));
+		}
+		m_condition.notify_all();
+	}
+
 	void Stop() override
 	{
 		PLOGD << std::format("stop {} thread(s) executor", std::size(m_threads));
@@ -123,9 +146,10 @@ private:
 				auto taskResult = task();
 				PLOGD << name << " finished";
 
-				m_forwarder->Forward([id, taskResult = std::move(taskResult)] {
-					taskResult(id);
-				});
+				if (taskResult)
+					m_forwarder->Forward([id, taskResult = std::move(taskResult)] {
+						taskResult(id);
+					});
 			}
 			catch (const std::exception& ex)
 			{
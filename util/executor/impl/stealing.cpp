@@ -0,0 +1,304 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <thread>
+
+#include <QTimer>
+
+#include "fnd/NonCopyMovable.h"
+
+#include "executor/batch.h"
+#include "executor/factory.h"
+#include "executor/metrics.h"
+
+#include "FunctorExecutionForwarder.h"
+#include "IExecutor.h"
+#include "log.h"
+
+namespace HomeCompa::Util::ExecutorPrivate::Stealing
+{
+
+namespace
+{
+
+constexpr int DEFAULT_PRIORITY = 1024;
+
+class IPool // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+	virtual ~IPool()                                 = default;
+	virtual void Work(size_t index, std::stop_token) = 0;
+};
+
+class Thread
+{
+public:
+	Thread(IPool& pool, const size_t index)
+		: m_thread(std::bind_front(&IPool::Work, std::ref(pool), index))
+	{
+	}
+
+private:
+	std::jthread m_thread;
+};
+
+struct WorkerQueue
+{
+	std::mutex                  guard;
+	std::deque<IExecutor::Task> tasks;
+};
+
+class Executor final
+	: virtual public IExecutor
+	, virtual public IPool
+{
+	NON_COPY_MOVABLE(Executor)
+
+public:
+	explicit Executor(ExecutorInitializer initializer)
+		: m_initializer { std::move(initializer) }
+		, m_forwarder { new FunctorExecutionForwarder }
+	{
+		const auto cpuCount       = static_cast<int>(std::thread::hardware_concurrency());
+		const auto maxThreadCount = static_cast<size_t>(std::min(std::max(cpuCount - 2, 1), m_initializer.maxThreadCount));
+
+		m_queues.reserve(maxThreadCount);
+		std::generate_n(std::back_inserter(m_queues), maxThreadCount, [] {
+			return std::make_unique<WorkerQueue>();
+		});
+
+		m_threads.reserve(maxThreadCount);
+		for (size_t i = 0; i < maxThreadCount; ++i)
+			m_threads.emplace_back(std::make_unique<Thread>(*this, i));
+
+		PLOGD << std::format("{} thread(s) work stealing executor created", std::size(m_threads));
+	}
+
+	~Executor() override
+	{
+		Stop();
+		QTimer::singleShot(0, [forwarder = m_forwarder] {
+			delete forwarder;
+		});
+	}
+
+private: // Util::IExecutor
+	size_t operator()(Task&& task, const int priority, const bool displace) override
+	{
+		const auto id = task.id;
+		if (m_initializer.metrics)
+			task = m_initializer.metrics->Instrument(std::move(task));
+
+		// Tasks with an explicit priority keep the Async executor semantics (ordering and displacement), so they share a small ordered lane.
+		// Everything else is spread over the per-worker queues and balanced by stealing.
+		if (priority)
+		{
+			std::lock_guard lock(m_priorityGuard);
+			if (displace)
+				m_pending -= static_cast<ptrdiff_t>(ExecutorPrivate::Displace(m_priorityTasks, priority));
+
+			m_priorityTasks.emplace(priority, std::move(task));
+			m_priorityCount.store(m_priorityTasks.size(), std::memory_order_release);
+			m_priorityHead.store(m_priorityTasks.begin()->first, std::memory_order_release);
+		}
+		else
+		{
+			auto& queue = *m_queues[m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size()];
+			std::lock_guard lock(queue.guard);
+			queue.tasks.push_back(std::move(task));
+		}
+
+		++m_pending;
+		if (m_sleeping.load() > 0)
+		{
+			std::lock_guard lock(m_idleGuard);
+			m_condition.notify_one();
+		}
+
+		return id;
+	}
+
+	void operator()(const std::span<Task> tasks, BatchResult onBatchFinished, const int priority) override
+	{
+		auto batch = CreateBatch(tasks, std::move(onBatchFinished));
+		if (m_initializer.metrics)
+			for (auto& task : batch)
+				task = m_initializer.metrics->Instrument(std::move(task));
+
+		if (priority)
+		{
+			std::lock_guard lock(m_priorityGuard);
+			for (auto& task : batch)
+				m_priorityTasks.emplace(priority, std::move(task));
+			m_priorityCount.store(m_priorityTasks.size(), std::memory_order_release);
+			m_priorityHead.store(m_priorityTasks.begin()->first, std::memory_order_release);
+		}
+		else
+		{
+			// contiguous chunks keep one lock acquisition per worker queue
+			const auto queueCount = m_queues.size();
+			const auto chunkSize  = (batch.size() + queueCount - 1) / queueCount;
+			const auto first      = m_nextQueue.fetch_add(queueCount, std::memory_order_relaxed);
+			for (size_t i = 0, offset = 0; offset < batch.size(); ++i, offset += chunkSize)
+			{
+				auto&           queue = *m_queues[(first + i) % queueCount];
+				std::lock_guard lock(queue.guard);
+				std::ranges::move(batch | std::views::drop(offset) | std::views::take(chunkSize), std::back_inserter(queue.tasks));
+			}
+		}
+
+		m_pending += static_cast<ptrdiff_t>(batch.size());
+		if (m_sleeping.load() > 0)
+		{
+			std::lock_guard lock(m_idleGuard);
+			m_condition.notify_all();
+		}
+	}
+
+	void Stop() override
+	{
+		PLOGD << std::format("stop {} thread(s) work stealing executor", std::size(m_threads));
+		m_threads.clear();
+	}
+
+private: // IPool
+	void Work(const size_t index, const std::stop_token stop) override
+	{
+		while (!stop.stop_requested())
+		{
+			auto taskOpt = GetTask(index);
+			if (!taskOpt)
+			{
+				std::unique_lock lock(m_idleGuard);
+				++m_sleeping;
+				m_condition.wait(lock, stop, [this] {
+					return m_pending.load() > 0;
+				});
+				--m_sleeping;
+				continue;
+			}
+
+			--m_pending;
+			Execute(*taskOpt);
+		}
+
+		m_initializer.onDestroy();
+	}
+
+private:
+	std::optional<Task> GetTask(const size_t index)
+	{
+		if (m_priorityCount.load(std::memory_order_acquire) && m_priorityHead.load(std::memory_order_acquire) < DEFAULT_PRIORITY)
+			if (auto task = PopPriority(DEFAULT_PRIORITY))
+				return task;
+
+		if (auto task = PopFront(*m_queues[index]))
+			return task;
+
+		for (size_t i = 1, sz = m_queues.size(); i < sz; ++i)
+			if (auto task = StealBack(*m_queues[(index + i) % sz]))
+				return task;
+
+		if (m_priorityCount.load(std::memory_order_acquire))
+			return PopPriority(std::numeric_limits<int>::max());
+
+		return std::nullopt;
+	}
+
+	std::optional<Task> PopPriority(const int limit)
+	{
+		std::lock_guard lock(m_priorityGuard);
+		if (m_priorityTasks.empty() || m_priorityTasks.begin()->first >= limit)
+			return std::nullopt;
+
+		const auto it   = m_priorityTasks.begin();
+		auto       task = std::move(it->second);
+		m_priorityTasks.erase(it);
+		m_priorityCount.store(m_priorityTasks.size(), std::memory_order_release);
+		if (!m_priorityTasks.empty())
+			m_priorityHead.store(m_priorityTasks.begin()->first, std::memory_order_release);
+
+		return task;
+	}
+
+	static std::optional<Task> PopFront(WorkerQueue& queue)
+	{
+		std::lock_guard lock(queue.guard);
+		if (queue.tasks.empty())
+			return std::nullopt;
+
+		auto task = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+		return task;
+	}
+
+	static std::optional<Task> StealBack(WorkerQueue& queue)
+	{
+		std::unique_lock lock(queue.guard, std::try_to_lock);
+		if (!lock.owns_lock() || queue.tasks.empty())
+			return std::nullopt;
+
+		auto task = std::move(queue.tasks.back());
+		queue.tasks.pop_back();
+		return task;
+	}
+
+	void Execute(Task& task)
+	{
+		const auto& [name, functor, id] = task;
+
+		m_forwarder->Forward(m_initializer.beforeExecute);
+		try
+		{
+			PLOGD << name << " started";
+			auto taskResult = functor();
+			PLOGD << name << " finished";
+
+			if (taskResult)
+				m_forwarder->Forward([id, taskResult = std::move(taskResult)] {
+					taskResult(id);
+				});
+		}
+		catch (const std::exception& ex)
+		{
+			PLOGE << name << ": " << ex.what();
+		}
+		catch (...)
+		{
+			PLOGE << name << " failed";
+		}
+		m_forwarder->Forward(m_initializer.afterExecute);
+	}
+
+private:
+	const ExecutorInitializer                 m_initializer;
+	FunctorExecutionForwarder*                m_forwarder { nullptr };
+	std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+	std::atomic_size_t                        m_nextQueue { 0 };
+
+	std::mutex               m_priorityGuard;
+	std::multimap<int, Task> m_priorityTasks;
+	std::atomic_size_t       m_priorityCount { 0 };
+	std::atomic_int          m_priorityHead { DEFAULT_PRIORITY };
+
+	std::atomic<ptrdiff_t>      m_pending { 0 };
+	std::atomic_int             m_sleeping { 0 };
+	std::mutex                  m_idleGuard;
+	std::condition_variable_any m_condition;
+
+	std::vector<std::unique_ptr<Thread>> m_threads;
+};
+
+} // namespace
+
+std::unique_ptr<IExecutor> CreateExecutor(ExecutorInitializer initializer)
+{
+	return std::make_unique<Executor>(std::move(initializer));
+}
+
+} // namespace HomeCompa::Util::ExecutorPrivate::Stealing
@@ -1,6 +1,8 @@
 #include <memory>
 
+#include "executor/batch.h"
 #include "executor/factory.h"
+#include "executor/metrics.h"
 
 #include "IExecutor.h"
 #include "log.h"
@@ -28,15 +30,25 @@ public:
 private: // Util::IExecutor
 	size_t operator()(Task&& task, int /*priority*/, bool) override
 	{
+		if (m_initializer.metrics)
+			task = m_initializer.metrics->Instrument(std::move(task));
+
 		m_initializer.beforeExecute();
 		PLOGD << task.name << " started";
 		const auto taskResult = task.task();
 		PLOGD << task.name << " finished";
-		taskResult(task.id);
+		if (taskResult)
+			taskResult(task.id);
 		m_initializer.afterExecute();
 		return task.id;
 	}
 
+	void operator()(const std::span<Task> tasks, BatchResult onBatchFinished, int /*priority*/) override
+	{
+		for (auto& task : CreateBatch(tasks, std::move(onBatchFinished)))
+			(*this)(std::move(task), 0, false);
+	}
+
 	void Stop() override
 	{
 	}
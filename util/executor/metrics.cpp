@@ -0,0 +1,188 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "fnd/ScopedCall.h"
+
+#include "log.h"
+
+using namespace HomeCompa::Util;
+
+namespace
+{
+
+std::string ToString(const ExecutorMetrics::Histogram& histogram)
+{
+	return std::format(
+		"avg {}us, p50 {}us, p90 {}us, p99 {}us, max {}us",
+		histogram.Average().count(),
+		histogram.Percentile(.5).count(),
+		histogram.Percentile(.9).count(),
+		histogram.Percentile(.99).count(),
+		histogram.max.count()
+	);
+}
+
+/// counts the task in the queue depth until it is run or dropped unrun (displaced, left in the queue on stop)
+class QueuedToken
+{
+public:
+	explicit QueuedToken(std::atomic_size_t& queueDepth) noexcept
+		: m_queueDepth { &queueDepth }
+	{
+	}
+
+	QueuedToken(QueuedToken&& rhs) noexcept
+		: m_queueDepth { std::exchange(rhs.m_queueDepth, nullptr) }
+	{
+	}
+
+	QueuedToken(const QueuedToken&)            = delete;
+	QueuedToken& operator=(const QueuedToken&) = delete;
+	QueuedToken& operator=(QueuedToken&&)      = delete;
+
+	~QueuedToken()
+	{
+		Release();
+	}
+
+	void Release() noexcept
+	{
+		if (m_queueDepth)
+			--*std::exchange(m_queueDepth, nullptr);
+	}
+
+private:
+	std::atomic_size_t* m_queueDepth;
+};
+
+}
+
+void ExecutorMetrics::Histogram::Add(const Duration duration) noexcept
+{
+	const auto us = static_cast<uint64_t>(std::max(duration.count(), Duration::rep { 0 }));
+	++buckets[std::min(static_cast<size_t>(std::bit_width(us)), BUCKET_COUNT - 1)];
+	++count;
+	total += duration;
+	max    = std::max(max, duration);
+}
+
+ExecutorMetrics::Duration ExecutorMetrics::Histogram::Average() const noexcept
+{
+	return count ? total / static_cast<Duration::rep>(count) : Duration { 0 };
+}
+
+ExecutorMetrics::Duration ExecutorMetrics::Histogram::Percentile(const double value) const noexcept
+{
+	const auto threshold = static_cast<size_t>(std::ceil(static_cast<double>(count) * value));
+	size_t     cumulative { 0 };
+	for (size_t i = 0; i < BUCKET_COUNT; ++i)
+		if ((cumulative += buckets[i]) >= threshold && cumulative)
+			return std::min(Duration { i ? (Duration::rep { 1 } << i) - 1 : 0 }, max);
+
+	return max;
+}
+
+struct ExecutorMetrics::Impl
+{
+	mutable std::mutex                              guard;
+	std::unordered_map<std::string, TaskStatistics> tasks;
+
+	std::atomic_size_t queueDepth { 0 };
+	std::atomic_size_t maxQueueDepth { 0 };
+
+	std::condition_variable_any dumpCondition;
+	std::jthread                dumpThread;
+
+	void OnEnqueued() noexcept
+	{
+		const auto depth = ++queueDepth;
+		for (auto maxDepth = maxQueueDepth.load(std::memory_order_relaxed); depth > maxDepth && !maxQueueDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed);) { }
+	}
+
+	void OnFinished(const std::string& name, const Clock::time_point enqueued, const Clock::time_point started, const Clock::time_point finished)
+	{
+		const auto wait = std::chrono::duration_cast<Duration>(started - enqueued);
+		const auto run  = std::chrono::duration_cast<Duration>(finished - started);
+
+		std::lock_guard lock(guard);
+		auto&           statistics = tasks[name];
+		statistics.wait.Add(wait);
+		statistics.run.Add(run);
+	}
+};
+
+ExecutorMetrics::ExecutorMetrics(const std::chrono::seconds dumpInterval)
+{
+	if (dumpInterval <= std::chrono::seconds::zero())
+		return;
+
+	m_impl->dumpThread = std::jthread([this, dumpInterval](const std::stop_token& stop) {
+		std::mutex       dumpGuard;
+		std::unique_lock lock(dumpGuard);
+		while (!m_impl->dumpCondition.wait_for(lock, stop, dumpInterval, [] {
+			return false;
+		}) && !stop.stop_requested())
+			Dump();
+	});
+}
+
+ExecutorMetrics::~ExecutorMetrics()
+{
+	if (!m_impl->dumpThread.joinable())
+		return;
+
+	m_impl->dumpThread.request_stop();
+	m_impl->dumpThread.join();
+}
+
+IExecutor::Task ExecutorMetrics::Instrument(IExecutor::Task task)
+{
+	m_impl->OnEnqueued();
+	task.task = [this, name = task.name, enqueued = Clock::now(), queued = QueuedToken(m_impl->queueDepth), task = std::move(task.task)]() mutable -> IExecutor::TaskResult {
+		queued.Release();
+		const auto       started = Clock::now();
+		const ScopedCall finishGuard([&] {
+			m_impl->OnFinished(name, enqueued, started, Clock::now());
+		});
+		return task();
+	};
+	return task;
+}
+
+ExecutorMetrics::Snapshot ExecutorMetrics::GetSnapshot() const
+{
+	Snapshot snapshot {
+		.queueDepth    = m_impl->queueDepth,
+		.maxQueueDepth = m_impl->maxQueueDepth,
+	};
+
+	{
+		std::lock_guard lock(m_impl->guard);
+		snapshot.tasks.reserve(m_impl->tasks.size());
+		for (const auto& [name, statistics] : m_impl->tasks)
+		{
+			auto& item = snapshot.tasks.emplace_back(statistics);
+			item.name  = name;
+		}
+	}
+
+	std::ranges::sort(snapshot.tasks, {}, &TaskStatistics::name);
+	return snapshot;
+}
+
+void ExecutorMetrics::Dump() const
+{
+	const auto snapshot = GetSnapshot();
+	PLOGI << std::format("executor queue depth: {}, max: {}", snapshot.queueDepth, snapshot.maxQueueDepth);
+	for (const auto& item : snapshot.tasks)
+		PLOGI << std::format("{}: {} task(s), wait: {}; run: {}", item.name, item.run.count, ToString(item.wait), ToString(item.run));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "fnd/NonCopyMovable.h"
+#include "fnd/memory.h"
+
+#include "IExecutor.h"
+
+#include "export/util.h"
+
+namespace HomeCompa::Util
+{
+
+/// opt-in executor instrumentation: queue wait and run time histograms per task name and queue depth
+class UTIL_EXPORT ExecutorMetrics
+{
+	NON_COPY_MOVABLE(ExecutorMetrics)
+
+public:
+	using Clock    = std::chrono::steady_clock;
+	using Duration = std::chrono::microseconds;
+
+	struct Histogram
+	{
+		/// bucket n counts durations in [2^(n-1), 2^n) microseconds, the last one counts everything longer
+		static constexpr size_t BUCKET_COUNT = 32;
+
+		std::array<size_t, BUCKET_COUNT> buckets {};
+		size_t                           count { 0 };
+		Duration                         total { 0 };
+		Duration                         max { 0 };
+
+		void     Add(Duration duration) noexcept;
+		Duration Average() const noexcept;
+		Duration Percentile(double value) const noexcept;
+	};
+
+	struct TaskStatistics
+	{
+		std::string name;
+		Histogram   wait;
+		Histogram   run;
+	};
+
+	struct Snapshot
+	{
+		std::vector<TaskStatistics> tasks;
+		size_t                      queueDepth { 0 };
+		size_t                      maxQueueDepth { 0 };
+	};
+
+public:
+	/// non-zero dumpInterval starts a thread that writes the snapshot to the log periodically
+	explicit ExecutorMetrics(std::chrono::seconds dumpInterval = std::chrono::seconds::zero());
+	~ExecutorMetrics();
+
+public:
+	/// called by executors on enqueue, the returned task reports its timings on execution
+	IExecutor::Task Instrument(IExecutor::Task task);
+
+	Snapshot GetSnapshot() const;
+	void     Dump() const;
+
+private:
+	struct Impl;
+	PropagateConstPtr<Impl> m_impl;
+};
+
+}
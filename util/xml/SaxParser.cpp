@@ -1,5 +1,9 @@
 #include "SaxParser.h"
 
+#include <array>
+#include <cstring>
+#include <ranges>
+
 #include <QIODevice>
 #include <QStringList>
 
@@ -11,7 +15,9 @@
 #include "fnd/ScopedCall.h"
 
 #include "Initializer.h"
+#include "QtTypes.h"
 #include "XmlAttributes.h"
+#include "XmlTokenizer.h"
 #include "log.h"
 
 using namespace HomeCompa;
@@ -32,9 +38,7 @@ public:
 private: // SaxParser::Attributes
 	QString GetAttribute(const QString& key) const override
 	{
-		if (const auto value = m_attributes->getValue(key.toStdU16String().data()))
-			return QString::fromStdU16String(value);
-		return {};
+		return GetAttributeView(key).toString();
 	}
 
 	size_t GetCount() const override
@@ -54,6 +58,26 @@ private: // SaxParser::Attributes
 		return QString::fromStdU16String(m_attributes->getValue(index));
 	}
 
+	QStringView GetAttributeView(const QStringView key) const override
+	{
+		for (XMLSize_t i = 0, sz = m_attributes->getLength(); i < sz; ++i)
+			if (QStringView(m_attributes->getName(i)) == key)
+				return QStringView(m_attributes->getValue(i));
+		return {};
+	}
+
+	QStringView GetNameView(const size_t index) const override
+	{
+		assert(index < GetCount());
+		return QStringView(m_attributes->getName(index));
+	}
+
+	QStringView GetValueView(const size_t index) const override
+	{
+		assert(index < GetCount());
+		return QStringView(m_attributes->getValue(index));
+	}
+
 private:
 	const xercesc::AttributeList* m_attributes { nullptr };
 };
@@ -90,6 +114,200 @@ private:
 	QStringList                    m_data;
 };
 
+/// registered paths as a tree of element names, a node index is the path id
+class PathTree
+{
+	using PathId = SaxParser::PathId;
+
+	struct Node
+	{
+		std::u16string      name;
+		int                 depth { 0 };
+		std::vector<PathId> children;
+	};
+
+public:
+	bool IsEmpty() const noexcept
+	{
+		return m_nodes.size() == 1;
+	}
+
+	PathId Register(const std::string_view path)
+	{
+		PathId id = ROOT;
+		for (const auto tag : path | std::views::split('/'))
+		{
+			const std::u16string name(std::ranges::begin(tag), std::ranges::end(tag));
+			if (const auto child = Find(id, name.data()); child != SaxParser::UNKNOWN_PATH)
+			{
+				id = child;
+				continue;
+			}
+
+			const auto child = static_cast<PathId>(m_nodes.size());
+			m_nodes.emplace_back(name, m_nodes[static_cast<size_t>(id)].depth + 1);
+			m_nodes[static_cast<size_t>(id)].children.push_back(child);
+			id = child;
+		}
+
+		assert(id != ROOT);
+		return id;
+	}
+
+	PathId GetChild(const PathId parent, const XMLCh* const name) const noexcept
+	{
+		return parent == SaxParser::UNKNOWN_PATH ? SaxParser::UNKNOWN_PATH : Find(parent, name);
+	}
+
+	int GetDepth(const PathId id) const noexcept
+	{
+		assert(id > ROOT && static_cast<size_t>(id) < m_nodes.size());
+		return m_nodes[static_cast<size_t>(id)].depth;
+	}
+
+public:
+	static constexpr PathId ROOT = 0;
+
+private:
+	PathId Find(const PathId parent, const XMLCh* const name) const noexcept
+	{
+		const auto& children = m_nodes[static_cast<size_t>(parent)].children;
+		const auto  it       = std::ranges::find_if(children, [&](const PathId child) {
+			return IsEqual(m_nodes[static_cast<size_t>(child)].name, name);
+		});
+		return it != children.end() ? *it : SaxParser::UNKNOWN_PATH;
+	}
+
+	static bool IsEqual(const std::u16string& lhs, const XMLCh* rhs) noexcept
+	{
+		const auto toLower = [](const char16_t ch) {
+			return ch >= u'A' && ch <= u'Z' ? static_cast<char16_t>(ch - u'A' + u'a') : ch;
+		};
+
+		for (const auto ch : lhs)
+			if (toLower(ch) != toLower(*rhs++))
+				return false;
+
+		return *rhs == 0;
+	}
+
+private:
+	std::vector<Node> m_nodes { Node {} };
+};
+
+/// ids of the current element path, one per level
+class PathStack
+{
+public:
+	explicit PathStack(const PathTree& tree)
+		: m_tree { tree }
+	{
+	}
+
+	void Push(const XMLCh* const tag)
+	{
+		m_data.push_back(m_tree.GetChild(m_data.empty() ? PathTree::ROOT : m_data.back(), tag));
+	}
+
+	void Pop()
+	{
+		assert(!m_data.empty());
+		m_data.pop_back();
+	}
+
+	SaxParser::PathId Current() const noexcept
+	{
+		return m_data.empty() ? SaxParser::UNKNOWN_PATH : m_data.back();
+	}
+
+	bool IsInside(const SaxParser::PathId id) const noexcept
+	{
+		const auto depth = static_cast<size_t>(m_tree.GetDepth(id));
+		return m_data.size() >= depth && m_data[depth - 1] == id;
+	}
+
+private:
+	const PathTree&                m_tree;
+	std::vector<SaxParser::PathId> m_data;
+};
+
+/// base64 text decoded chunk by chunk right into the sink, whitespace and invalid characters are skipped as QByteArray::fromBase64 does
+class Base64Decoder
+{
+	static constexpr auto TABLE = [] {
+		std::array<int8_t, 128> result {};
+		result.fill(-1);
+		constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		for (size_t i = 0; i < alphabet.size(); ++i)
+			result[static_cast<size_t>(alphabet[i])] = static_cast<int8_t>(i);
+		return result;
+	}();
+
+public:
+	bool IsActive() const noexcept
+	{
+		return !!m_sink;
+	}
+
+	int GetDepth() const noexcept
+	{
+		return m_depth;
+	}
+
+	void Start(QByteArray& sink, const int depth) noexcept
+	{
+		assert(!m_sink);
+		m_sink  = &sink;
+		m_depth = depth;
+		m_sink->clear();
+		m_buffer = 0;
+		m_bits   = 0;
+	}
+
+	void Append(const XMLCh* chars, const size_t length)
+	{
+		assert(m_sink);
+
+		const auto size     = m_sink->size();
+		const auto required = size + static_cast<qsizetype_t>(length * 3 / 4 + 3);
+		if (m_sink->capacity() < required)
+			m_sink->reserve(std::max(required, 2 * m_sink->capacity()));
+
+		m_sink->resize(required);
+		auto* dst   = m_sink->data() + size;
+		auto* begin = dst;
+
+		for (const auto* end = chars + length; chars != end; ++chars)
+		{
+			const auto ch = *chars;
+			if (ch >= TABLE.size() || TABLE[ch] < 0)
+				continue;
+
+			m_buffer  = m_buffer << 6 | static_cast<uint32_t>(TABLE[ch]);
+			m_bits   += 6;
+			if (m_bits >= 8)
+			{
+				m_bits -= 8;
+				*dst++  = static_cast<char>(m_buffer >> m_bits);
+			}
+		}
+
+		m_sink->resize(size + (dst - begin));
+	}
+
+	void Finish() noexcept
+	{
+		m_sink  = nullptr;
+		m_depth = -1;
+	}
+
+private:
+	QByteArray* m_sink { nullptr };
+	int         m_depth { -1 };
+	uint32_t    m_buffer { 0 };
+	int         m_bits { 0 };
+};
+
 class BinInputStream final : public xercesc_3_3::BinInputStream
 {
 public:
@@ -109,10 +327,17 @@ public:
 		return m_stopped;
 	}
 
+	/// the bytes already read from the source are given first
+	void SetPrefix(QByteArray prefix) noexcept
+	{
+		m_prefix         = std::move(prefix);
+		m_prefixPosition = 0;
+	}
+
 private: // xercesc::BinInputStream
 	XMLFilePos curPos() const override
 	{
-		return m_source.pos();
+		return m_source.pos() - (m_prefix.size() - m_prefixPosition);
 	}
 
 	const XMLCh* getContentType() const override
@@ -122,13 +347,26 @@ private: // xercesc::BinInputStream
 
 	XMLSize_t readBytes(XMLByte* const toFill, const XMLSize_t maxToRead) override
 	{
-		return m_stopped ? 0 : m_source.read(reinterpret_cast<char*>(toFill), std::min(static_cast<int64_t>(maxToRead), m_maxChunkSize));
+		if (m_stopped)
+			return 0;
+
+		if (m_prefixPosition < m_prefix.size())
+		{
+			const auto size = std::min(static_cast<qsizetype_t>(maxToRead), m_prefix.size() - m_prefixPosition);
+			std::memcpy(toFill, m_prefix.constData() + m_prefixPosition, static_cast<size_t>(size));
+			m_prefixPosition += size;
+			return static_cast<XMLSize_t>(size);
+		}
+
+		return m_source.read(reinterpret_cast<char*>(toFill), std::min(static_cast<int64_t>(maxToRead), m_maxChunkSize));
 	}
 
 private:
 	QIODevice&    m_source;
 	const int64_t m_maxChunkSize;
 	bool          m_stopped { false };
+	QByteArray    m_prefix;
+	qsizetype_t   m_prefixPosition { 0 };
 };
 
 class InputSource final : public xercesc::InputSource
@@ -149,6 +387,11 @@ public:
 		return m_binInputStream->IsStopped();
 	}
 
+	void SetPrefix(QByteArray prefix) const noexcept
+	{
+		m_binInputStream->SetPrefix(std::move(prefix));
+	}
+
 private: // xercesc::InputSource
 	xercesc::BinInputStream* makeStream() const override
 	{
@@ -167,98 +410,133 @@ public:
 	virtual void XMLDecl(const XMLCh* const versionStr, const XMLCh* const encodingStr, const XMLCh* const standaloneStr, const XMLCh* const actualEncodingStr) = 0;
 };
 
-class SaxHandler final
-	: public xercesc::HandlerBase
-	, public IDeclHandler
+static_assert(std::is_same_v<XMLCh, char16_t>, "the tokenizer and Xerces events share the handler");
+
+/// the parser callbacks for the events of both the tokenizer and Xerces
+class EventHandler final : public XmlTokenizer::IHandler
 {
 public:
-	SaxHandler(SaxParser& parser, InputSource& inputSource)
+	EventHandler(SaxParser& parser, InputSource& inputSource, PathStack* pathStack, Base64Decoder& base64Decoder)
 		: m_parser(parser)
 		, m_inputSource(inputSource)
+		, m_pathStack(pathStack)
+		, m_base64Decoder(base64Decoder)
 	{
 	}
 
-private: // xercesc::DocumentHandler
-	void processingInstruction(const XMLCh* const target, const XMLCh* const data) override
+	int GetDepth() const noexcept
+	{
+		return m_depth;
+	}
+
+	void OnWarning(const size_t line, const size_t column, const QString& text)
 	{
-		ProcessCharacters();
 		if (m_inputSource.IsStopped())
 			return;
 
-		if (!m_parser.OnProcessingInstruction(QString::fromStdU16String(target), QString::fromStdU16String(data)))
+		if (!m_parser.OnWarning(line, column, text))
 			m_inputSource.SetStopped(true);
 	}
 
-	void startElement(const XMLCh* const name, xercesc::AttributeList& args) override
+	void OnError(const size_t line, const size_t column, const QString& text)
 	{
-		ProcessCharacters();
 		if (m_inputSource.IsStopped())
 			return;
 
-		m_stack.Push(name);
-		const auto& key = m_stack.ToString();
-		m_attributes.SetAttributeList(args);
-		if (!m_parser.OnStartElement(QString::fromStdU16String(name), key, m_attributes))
+		if (!m_parser.OnError(line, column, text))
 			m_inputSource.SetStopped(true);
 	}
 
-	void endElement(const XMLCh* const name) override
+public: // XmlTokenizer::IHandler
+	bool IsStopped() const noexcept override
+	{
+		return m_inputSource.IsStopped();
+	}
+
+	void OnXMLDecl(const XMLCh* const versionStr, const XMLCh* const encodingStr, const XMLCh* const standaloneStr, const XMLCh* const actualEncodingStr) override
 	{
 		if (m_inputSource.IsStopped())
 			return;
 
-		ProcessCharacters();
-
-		if (const auto& key = m_stack.ToString(); !m_parser.OnEndElement(QString::fromStdU16String(name), key))
+		if (!m_parser.OnXMLDecl(QString::fromStdU16String(versionStr), QString::fromStdU16String(encodingStr), QString::fromStdU16String(standaloneStr), QString::fromStdU16String(actualEncodingStr)))
 			m_inputSource.SetStopped(true);
-
-		m_stack.Pop(name);
 	}
 
-	void characters(const XMLCh* const chars, const XMLSize_t length) override
+	void OnProcessingInstruction(const XMLCh* const target, const XMLCh* const data) override
 	{
+		ProcessCharacters();
 		if (m_inputSource.IsStopped())
 			return;
 
-		if (length != 0)
-			m_characters.append(QString::fromStdU16String(chars));
+		if (!m_parser.OnProcessingInstruction(QString::fromStdU16String(target), QString::fromStdU16String(data)))
+			m_inputSource.SetStopped(true);
 	}
 
-private: // xercesc::ErrorHandler
-	void warning(const xercesc::SAXParseException& exc) override
+	void OnStartElement(const XMLCh* const name, const XmlAttributes& attributes) override
 	{
+		ProcessCharacters();
 		if (m_inputSource.IsStopped())
 			return;
 
-		if (!m_parser.OnWarning(exc.getLineNumber(), exc.getColumnNumber(), QString::fromStdU16String(exc.getMessage())))
+		++m_depth;
+
+		if (m_pathStack)
+		{
+			m_pathStack->Push(name);
+			if (!m_parser.OnStartElementId(QStringView(name), m_pathStack->Current(), attributes))
+				m_inputSource.SetStopped(true);
+			return;
+		}
+
+		m_stack.Push(name);
+		const auto& key = m_stack.ToString();
+		if (!m_parser.OnStartElement(QString::fromStdU16String(name), key, attributes))
 			m_inputSource.SetStopped(true);
 	}
 
-	void error(const xercesc::SAXParseException& exc) override
+	void OnEndElement(const XMLCh* const name) override
 	{
 		if (m_inputSource.IsStopped())
 			return;
 
-		if (!m_parser.OnError(exc.getLineNumber(), exc.getColumnNumber(), QString::fromStdU16String(exc.getMessage())))
+		ProcessCharacters();
+
+		if (m_base64Decoder.GetDepth() == m_depth)
+			m_base64Decoder.Finish();
+		--m_depth;
+
+		if (m_pathStack)
+		{
+			if (!m_parser.OnEndElementId(QStringView(name), m_pathStack->Current()))
+				m_inputSource.SetStopped(true);
+
+			m_pathStack->Pop();
+			return;
+		}
+
+		if (const auto& key = m_stack.ToString(); !m_parser.OnEndElement(QString::fromStdU16String(name), key))
 			m_inputSource.SetStopped(true);
+
+		m_stack.Pop(name);
 	}
 
-	void fatalError(const xercesc::SAXParseException& exc) override
+	void OnCharacters(const XMLCh* const chars, const size_t length) override
 	{
 		if (m_inputSource.IsStopped())
 			return;
 
-		if (!m_parser.OnFatalError(exc.getLineNumber(), exc.getColumnNumber(), QString::fromStdU16String(exc.getMessage())))
-			m_inputSource.SetStopped(true);
+		if (m_base64Decoder.IsActive())
+			return m_base64Decoder.Append(chars, length);
+
+		m_characters.append(chars, length);
 	}
 
-private: // IDeclHandler
-	void XMLDecl(const XMLCh* const versionStr, const XMLCh* const encodingStr, const XMLCh* const standaloneStr, const XMLCh* const actualEncodingStr) override
+	void OnFatalError(const size_t line, const size_t column, const QString& text) override
 	{
 		if (m_inputSource.IsStopped())
 			return;
 
-		if (!m_parser.OnXMLDecl(QString::fromStdU16String(versionStr), QString::fromStdU16String(encodingStr), QString::fromStdU16String(standaloneStr), QString::fromStdU16String(actualEncodingStr)))
+		if (!m_parser.OnFatalError(line, column, text))
 			m_inputSource.SetStopped(true);
 	}
 
@@ -272,20 +550,94 @@ private:
 			m_characters.clear();
 		});
 
-		if (m_characters.simplified().isEmpty())
+		const QStringView characters(m_characters);
+		if (std::ranges::all_of(characters, [](const QChar ch) {
+				return ch.isSpace();
+			}))
+			return;
+
+		if (m_pathStack)
+		{
+			if (!m_parser.OnCharactersId(m_pathStack->Current(), characters))
+				m_inputSource.SetStopped(true);
 			return;
+		}
 
-		if (const auto& key = m_stack.ToString(); !m_parser.OnCharacters(key, m_characters))
+		if (const auto& key = m_stack.ToString(); !m_parser.OnCharacters(key, characters.toString()))
 			m_inputSource.SetStopped(true);
 	}
 
 private:
-	XmlStack          m_stack;
-	XmlAttributesImpl m_attributes {};
+	XmlStack m_stack;
+
+	SaxParser&     m_parser;
+	InputSource&   m_inputSource;
+	PathStack*     m_pathStack;
+	Base64Decoder& m_base64Decoder;
+	int            m_depth { 0 };
 
-	SaxParser&   m_parser;
-	InputSource& m_inputSource;
-	QString      m_characters;
+	// reused between the text nodes, clear() keeps the capacity
+	std::u16string m_characters;
+};
+
+/// Xerces events to the common handler
+class SaxHandler final
+	: public xercesc::HandlerBase
+	, public IDeclHandler
+{
+public:
+	explicit SaxHandler(EventHandler& handler)
+		: m_handler(handler)
+	{
+	}
+
+private: // xercesc::DocumentHandler
+	void processingInstruction(const XMLCh* const target, const XMLCh* const data) override
+	{
+		m_handler.OnProcessingInstruction(target, data);
+	}
+
+	void startElement(const XMLCh* const name, xercesc::AttributeList& args) override
+	{
+		m_attributes.SetAttributeList(args);
+		m_handler.OnStartElement(name, m_attributes);
+	}
+
+	void endElement(const XMLCh* const name) override
+	{
+		m_handler.OnEndElement(name);
+	}
+
+	void characters(const XMLCh* const chars, const XMLSize_t length) override
+	{
+		m_handler.OnCharacters(chars, length);
+	}
+
+private: // xercesc::ErrorHandler
+	void warning(const xercesc::SAXParseException& exc) override
+	{
+		m_handler.OnWarning(exc.getLineNumber(), exc.getColumnNumber(), QString::fromStdU16String(exc.getMessage()));
+	}
+
+	void error(const xercesc::SAXParseException& exc) override
+	{
+		m_handler.OnError(exc.getLineNumber(), exc.getColumnNumber(), QString::fromStdU16String(exc.getMessage()));
+	}
+
+	void fatalError(const xercesc::SAXParseException& exc) override
+	{
+		m_handler.OnFatalError(exc.getLineNumber(), exc.getColumnNumber(), QString::fromStdU16String(exc.getMessage()));
+	}
+
+private: // IDeclHandler
+	void XMLDecl(const XMLCh* const versionStr, const XMLCh* const encodingStr, const XMLCh* const standaloneStr, const XMLCh* const actualEncodingStr) override
+	{
+		m_handler.OnXMLDecl(versionStr, encodingStr, standaloneStr, actualEncodingStr);
+	}
+
+private:
+	EventHandler&     m_handler;
+	XmlAttributesImpl m_attributes {};
 };
 
 class SAXParserImpl : public xercesc::SAXParser
@@ -307,6 +659,57 @@ private:
 	IDeclHandler* m_declHandler { nullptr };
 };
 
+/// Configured Xerces parsers of the thread, reused from document to document.
+/// The pool also keeps the platform initialized while the thread lives.
+class SAXParserPool
+{
+	static constexpr size_t MAX_SIZE = 4;
+
+public:
+	static SAXParserPool& Get()
+	{
+		thread_local SAXParserPool pool;
+		return pool;
+	}
+
+	/// nested parsers of the same thread get different instances
+	std::unique_ptr<SAXParserImpl> Acquire()
+	{
+		if (m_parsers.empty())
+			return Create();
+
+		auto parser = std::move(m_parsers.back());
+		m_parsers.pop_back();
+		return parser;
+	}
+
+	void Release(std::unique_ptr<SAXParserImpl> parser)
+	{
+		parser->setDocumentHandler(nullptr);
+		parser->setErrorHandler(nullptr);
+		parser->SetDeclHandler(nullptr);
+
+		if (m_parsers.size() < MAX_SIZE)
+			m_parsers.push_back(std::move(parser));
+	}
+
+private:
+	static std::unique_ptr<SAXParserImpl> Create()
+	{
+		auto parser = std::make_unique<SAXParserImpl>();
+		parser->setValidationScheme(xercesc::SAXParser::Val_Auto);
+		parser->setDoNamespaces(false);
+		parser->setDoSchema(false);
+		parser->setHandleMultipleImports(true);
+		parser->setValidationSchemaFullChecking(false);
+		return parser;
+	}
+
+private:
+	XMLPlatformInitializer                      m_initializer;
+	std::vector<std::unique_ptr<SAXParserImpl>> m_parsers;
+};
+
 } // namespace
 
 class SaxParser::Impl
@@ -314,30 +717,70 @@ class SaxParser::Impl
 public:
 	Impl(SaxParser& self, QIODevice& stream, const int64_t maxChunkSize)
 		: m_self(self)
+		, m_stream(stream)
+		, m_maxChunkSize(maxChunkSize)
 		, m_inputSource(stream, maxChunkSize)
 	{
-		m_saxParser.setValidationScheme(xercesc::SAXParser::Val_Auto);
-		m_saxParser.setDoNamespaces(false);
-		m_saxParser.setDoSchema(false);
-		m_saxParser.setHandleMultipleImports(true);
-		m_saxParser.setValidationSchemaFullChecking(false);
 	}
 
 	void Parse()
 	{
-		SaxHandler handler(m_self, m_inputSource);
-		m_saxParser.setDocumentHandler(&handler);
-		m_saxParser.setErrorHandler(&handler);
-		m_saxParser.SetDeclHandler(&handler);
+		if (!m_paths.IsEmpty())
+			m_pathStack.emplace(m_paths);
+
+		EventHandler handler(m_self, m_inputSource, m_pathStack ? &*m_pathStack : nullptr, m_base64Decoder);
+		m_handler = &handler;
+		const ScopedCall handlerGuard([this] {
+			m_handler = nullptr;
+		});
+
+		// well-formed UTF-8 documents without DTD are tokenized here, Xerces gets the rest with the prolog already read
+		if (XmlTokenizer tokenizer(m_stream, m_maxChunkSize); tokenizer.CanParse())
+			return tokenizer.Parse(handler);
+		else
+			m_inputSource.SetPrefix(tokenizer.TakeBuffer());
+
+		// the pool is per thread, the parser may be created on another thread than the one it parses on
+		auto&            pool      = SAXParserPool::Get();
+		auto             saxParser = pool.Acquire();
+		const ScopedCall saxParserGuard([&] {
+			pool.Release(std::move(saxParser));
+		});
+
+		SaxHandler saxHandler(handler);
+		saxParser->setDocumentHandler(&saxHandler);
+		saxParser->setErrorHandler(&saxHandler);
+		saxParser->SetDeclHandler(&saxHandler);
+
+		saxParser->parse(m_inputSource);
+	}
+
+	SaxParser::PathId RegisterPath(const std::string_view path)
+	{
+		assert(!m_pathStack && "paths must be registered before parsing");
+		return m_paths.Register(path);
+	}
 
-		m_saxParser.parse(m_inputSource);
+	bool IsInside(const SaxParser::PathId path) const noexcept
+	{
+		return m_pathStack && path != SaxParser::UNKNOWN_PATH && m_pathStack->IsInside(path);
+	}
+
+	void SetBinarySink(QByteArray& sink)
+	{
+		assert(m_handler && "the sink is set from the start element callbacks only");
+		m_base64Decoder.Start(sink, m_handler->GetDepth());
 	}
 
 private:
-	XMLPlatformInitializer m_initializer;
-	SAXParserImpl          m_saxParser;
-	SaxParser&             m_self;
-	InputSource            m_inputSource;
+	SaxParser&               m_self;
+	QIODevice&               m_stream;
+	const int64_t            m_maxChunkSize;
+	InputSource              m_inputSource;
+	PathTree                 m_paths;
+	std::optional<PathStack> m_pathStack;
+	Base64Decoder            m_base64Decoder;
+	const EventHandler*      m_handler { nullptr };
 };
 
 SaxParser::SaxParser(QIODevice& stream, const int64_t maxChunkSize)
@@ -357,6 +800,21 @@ bool SaxParser::IsLastItemProcessed() const noexcept
 	return m_processed;
 }
 
+SaxParser::PathId SaxParser::RegisterPath(const std::string_view path)
+{
+	return m_impl->RegisterPath(path);
+}
+
+bool SaxParser::IsInside(const PathId path) const noexcept
+{
+	return m_impl->IsInside(path);
+}
+
+void SaxParser::SetBinarySink(QByteArray& sink)
+{
+	m_impl->SetBinarySink(sink);
+}
+
 bool SaxParser::OnProcessingInstruction(const QString& /*target*/, const QString& /*data*/)
 {
 	return true;
@@ -382,6 +840,21 @@ bool SaxParser::OnCharacters(const QString& /*path*/, const QString& /*value*/)
 	return true;
 }
 
+bool SaxParser::OnStartElementId(QStringView /*name*/, PathId /*path*/, const XmlAttributes& /*attributes*/)
+{
+	return true;
+}
+
+bool SaxParser::OnEndElementId(QStringView /*name*/, PathId /*path*/)
+{
+	return true;
+}
+
+bool SaxParser::OnCharactersId(PathId /*path*/, QStringView /*value*/)
+{
+	return true;
+}
+
 bool SaxParser::OnWarning(const size_t line, const size_t column, const QString& text)
 {
 	PLOGW << line << ":" << column << " " << text;
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string_view>
+#include <vector>
+
 #include <QString>
 
 #include "fnd/FindPair.h"
@@ -19,6 +22,10 @@ class UTIL_EXPORT SaxParser
 {
 	NON_COPY_MOVABLE(SaxParser)
 
+public:
+	using PathId                         = int;
+	static constexpr PathId UNKNOWN_PATH = -1;
+
 public:
 	struct PszComparerEndsWithCaseInsensitive
 	{
@@ -48,8 +55,42 @@ protected:
 		return std::invoke(parser, obj, std::cref(args)...);
 	}
 
+	template <typename Obj, typename Value, typename... ARGS>
+	bool Parse(Obj& obj, const std::vector<Value>& parsers, const PathId path, const ARGS&... args)
+	{
+		m_processed       = true;
+		const auto  index = static_cast<size_t>(path);
+		const Value parser { index < parsers.size() && parsers[index] ? parsers[index] : &SaxParser::Stub<ARGS...> };
+		return std::invoke(parser, obj, std::cref(args)...);
+	}
+
 	bool IsLastItemProcessed() const noexcept;
 
+	/// Path interning mode: the paths are registered before parsing, the Id callbacks get the id of the current element path instead of the path string.
+	/// Elements are matched ASCII case-insensitively, unregistered paths and their descendants come as UNKNOWN_PATH.
+	PathId RegisterPath(std::string_view path);
+
+	/// registers the array paths, the result is indexed by their ids
+	template <typename Value, size_t ArraySize>
+	std::vector<Value> RegisterPaths(const std::pair<const char*, Value> (&array)[ArraySize])
+	{
+		std::vector<Value> result;
+		for (const auto& [path, value] : array)
+		{
+			const auto id = static_cast<size_t>(RegisterPath(path));
+			result.resize(std::max(result.size(), id + 1));
+			result[id] = value;
+		}
+		return result;
+	}
+
+	/// the current element is the registered path one or its descendant
+	bool IsInside(PathId path) const noexcept;
+
+	/// Called from a start element callback: the element text is decoded from base64 straight into the sink while it is read,
+	/// the character callbacks do not get it. The sink is complete by the end element callback.
+	void SetBinarySink(QByteArray& sink);
+
 private:
 	template <typename... ARGS>
 	// ReSharper disable once CppMemberFunctionMayBeStatic
@@ -70,6 +111,11 @@ public:
 	virtual bool OnEndElement(const QString& name, const QString& path);
 	virtual bool OnCharacters(const QString& path, const QString& value);
 
+	// the views point to the parser buffers and are valid during the call only
+	virtual bool OnStartElementId(QStringView name, PathId path, const XmlAttributes& attributes);
+	virtual bool OnEndElementId(QStringView name, PathId path);
+	virtual bool OnCharactersId(PathId path, QStringView value);
+
 	virtual bool OnWarning(size_t line, size_t column, const QString& text);
 	virtual bool OnError(size_t line, size_t column, const QString& text);
 	virtual bool OnFatalError(size_t line, size_t column, const QString& text);
@@ -1,5 +1,9 @@
 #include "Validator.h"
 
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
 #include <QIODevice>
 #include <QStringList>
 
@@ -10,9 +14,18 @@
 #include <xercesc/dom/DOMImplementationRegistry.hpp>
 #include <xercesc/dom/DOMLSParser.hpp>
 #include <xercesc/dom/DOMLocator.hpp>
+#include <xercesc/framework/LocalFileInputSource.hpp>
 #include <xercesc/framework/MemBufInputSource.hpp>
 #include <xercesc/framework/Wrapper4InputSource.hpp>
+#include <xercesc/internal/XMLGrammarPoolImpl.hpp>
 #include <xercesc/parsers/AbstractDOMParser.hpp>
+#include <xercesc/sax/ErrorHandler.hpp>
+#include <xercesc/sax/SAXParseException.hpp>
+#include <xercesc/sax2/SAX2XMLReader.hpp>
+#include <xercesc/sax2/XMLReaderFactory.hpp>
+#include <xercesc/validators/common/Grammar.hpp>
+
+#include "executor/ThreadPool.h"
 
 #include "Initializer.h"
 
@@ -94,6 +107,116 @@ QString ValidateImpl(QIODevice& input)
 	return errorHandler.GetErrors();
 }
 
+/// SAX errors of a single document
+class ErrorCollector final : public xercesc::ErrorHandler
+{
+public:
+	XmlBatchValidator::Errors TakeErrors() noexcept
+	{
+		auto result = std::move(m_errors);
+		m_errors    = {};
+		return result;
+	}
+
+	bool HasErrors() const noexcept
+	{
+		return std::ranges::any_of(m_errors, [](const auto& item) {
+			return item.severity != XmlBatchValidator::Error::Severity::Warning;
+		});
+	}
+
+	void Add(const XmlBatchValidator::Error::Severity severity, QString text)
+	{
+		m_errors.emplace_back(severity, 0, 0, std::move(text));
+	}
+
+private: // xercesc::ErrorHandler
+	void warning(const xercesc::SAXParseException& exc) override
+	{
+		Add(XmlBatchValidator::Error::Severity::Warning, exc);
+	}
+
+	void error(const xercesc::SAXParseException& exc) override
+	{
+		Add(XmlBatchValidator::Error::Severity::Error, exc);
+	}
+
+	void fatalError(const xercesc::SAXParseException& exc) override
+	{
+		Add(XmlBatchValidator::Error::Severity::FatalError, exc);
+	}
+
+	void resetErrors() override
+	{
+	}
+
+private:
+	void Add(const XmlBatchValidator::Error::Severity severity, const xercesc::SAXParseException& exc)
+	{
+		m_errors.emplace_back(severity, static_cast<size_t>(exc.getLineNumber()), static_cast<size_t>(exc.getColumnNumber()), QString::fromStdU16String(exc.getMessage()));
+	}
+
+private:
+	XmlBatchValidator::Errors m_errors;
+};
+
+/// a validating SAX reader of a thread, the grammar comes from the shared pool only
+struct ValidationContext
+{
+	std::unique_ptr<ErrorCollector>         errors { std::make_unique<ErrorCollector>() };
+	std::unique_ptr<xercesc::SAX2XMLReader> reader;
+
+	explicit ValidationContext(xercesc::XMLGrammarPool* grammarPool)
+		: reader { xercesc::XMLReaderFactory::createXMLReader(xercesc::XMLPlatformUtils::fgMemoryManager, grammarPool) }
+	{
+		reader->setFeature(xercesc::XMLUni::fgSAX2CoreNameSpaces, true);
+		reader->setFeature(xercesc::XMLUni::fgSAX2CoreValidation, true);
+		reader->setFeature(xercesc::XMLUni::fgXercesDynamic, false);
+		reader->setFeature(xercesc::XMLUni::fgXercesSchema, true);
+		reader->setFeature(xercesc::XMLUni::fgXercesSchemaFullChecking, false);
+		reader->setFeature(xercesc::XMLUni::fgXercesHandleMultipleImports, true);
+		reader->setFeature(xercesc::XMLUni::fgXercesUseCachedGrammarInParse, true);
+		reader->setFeature(xercesc::XMLUni::fgXercesLoadSchema, false);
+		reader->setErrorHandler(errors.get());
+	}
+
+	XmlBatchValidator::Errors Validate(QIODevice* input)
+	{
+		if (!input)
+		{
+			errors->Add(XmlBatchValidator::Error::Severity::FatalError, "cannot open the document");
+			return errors->TakeErrors();
+		}
+
+		const auto                 body = input->readAll();
+		xercesc::MemBufInputSource inputSource(reinterpret_cast<const XMLByte*>(body.data()), static_cast<XMLSize_t>(body.size()), "");
+
+		try
+		{
+			reader->parse(inputSource);
+		}
+		catch (const xercesc::XMLException& ex)
+		{
+			errors->Add(XmlBatchValidator::Error::Severity::FatalError, QString::fromStdU16String(ex.getMessage()));
+		}
+		catch (const xercesc::SAXException& ex)
+		{
+			errors->Add(XmlBatchValidator::Error::Severity::FatalError, QString::fromStdU16String(ex.getMessage()));
+		}
+
+		return errors->TakeErrors();
+	}
+
+	/// the errors collected before the failure are kept
+	XmlBatchValidator::Errors Fail(QString text)
+	{
+		errors->Add(XmlBatchValidator::Error::Severity::FatalError, std::move(text));
+		return errors->TakeErrors();
+	}
+};
+
+using ValidationPool = ThreadPool<std::unique_ptr<ValidationContext>>;
+
 } // namespace
 
 class XmlValidator::Impl
@@ -110,3 +233,75 @@ QString XmlValidator::Validate(QIODevice& input) const
 {
 	return ValidateImpl(input);
 }
+
+class XmlBatchValidator::Impl
+{
+public:
+	explicit Impl(const QString& schemaPath)
+	{
+		ValidationContext context(m_grammarPool.get());
+
+		const auto                          path = schemaPath.toStdU16String();
+		const xercesc::LocalFileInputSource schema(path.data());
+		if (!context.reader->loadGrammar(schema, xercesc::Grammar::SchemaGrammarType, true) || context.errors->HasErrors())
+		{
+			const auto errors = context.errors->TakeErrors();
+			throw std::invalid_argument(std::format("cannot load schema {}: {}", schemaPath.toStdString(), errors.empty() ? std::string {} : errors.front().text.toStdString()));
+		}
+
+		// a locked pool is read only and can be shared by the threads
+		m_grammarPool->lockPool();
+	}
+
+	std::vector<Errors> Validate(const size_t count, const StreamGetter& streamGetter, const unsigned int threadCount) const
+	{
+		std::vector<Errors> result(count);
+
+		ValidationPool pool({
+			.threadCount   = std::max(threadCount, 1u),
+			.maxQueueSize  = 2ULL * std::max(threadCount, 1u),
+			.contextGetter = [this](size_t) {
+				return std::make_unique<ValidationContext>(m_grammarPool.get());
+			},
+		});
+
+		for (size_t index = 0; index < count; ++index)
+		{
+			pool.enqueue([&, index](std::unique_ptr<ValidationContext>& context, const std::stop_token&) {
+				try
+				{
+					const auto stream = streamGetter(index);
+					result[index]     = context->Validate(stream.get());
+				}
+				catch (const std::exception& ex)
+				{
+					result[index] = context->Fail(QString::fromStdString(ex.what()));
+				}
+				catch (...)
+				{
+					result[index] = context->Fail("unknown error");
+				}
+			});
+		}
+
+		pool.wait();
+
+		return result;
+	}
+
+private:
+	XMLPlatformInitializer                   m_initializer;
+	std::unique_ptr<xercesc::XMLGrammarPool> m_grammarPool { std::make_unique<xercesc::XMLGrammarPoolImpl>(xercesc::XMLPlatformUtils::fgMemoryManager) };
+};
+
+XmlBatchValidator::XmlBatchValidator(const QString& schemaPath)
+	: m_impl(schemaPath)
+{
+}
+
+XmlBatchValidator::~XmlBatchValidator() = default;
+
+std::vector<XmlBatchValidator::Errors> XmlBatchValidator::Validate(const size_t count, const StreamGetter& streamGetter, const unsigned int threadCount) const
+{
+	return m_impl->Validate(count, streamGetter, threadCount);
+}
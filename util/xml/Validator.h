@@ -1,12 +1,18 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <QString>
+
 #include "fnd/NonCopyMovable.h"
 #include "fnd/memory.h"
 
 #include "export/util.h"
 
 class QIODevice;
-class QString;
 
 namespace HomeCompa::Util
 {
@@ -27,4 +33,44 @@ private:
 	PropagateConstPtr<Impl> m_impl;
 };
 
+/// Schema validation of many documents at once: the grammar is parsed once and shared by the threads, the documents are checked by SAX without building DOM
+class UTIL_EXPORT XmlBatchValidator
+{
+	NON_COPY_MOVABLE(XmlBatchValidator)
+
+public:
+	struct Error
+	{
+		enum class Severity
+		{
+			Warning,
+			Error,
+			FatalError,
+		};
+
+		Severity severity { Severity::Error };
+		size_t   line { 0 };
+		size_t   column { 0 };
+		QString  text;
+	};
+
+	using Errors = std::vector<Error>;
+
+	/// called from the validating threads
+	using StreamGetter = std::function<std::unique_ptr<QIODevice>(size_t index)>;
+
+public:
+	/// throws if the schema cannot be loaded, its imports are resolved relative to its path
+	explicit XmlBatchValidator(const QString& schemaPath);
+	~XmlBatchValidator();
+
+public:
+	/// the result is indexed as the documents, a document without a stream gets a fatal error
+	std::vector<Errors> Validate(size_t count, const StreamGetter& streamGetter, unsigned int threadCount = std::thread::hardware_concurrency()) const;
+
+private:
+	class Impl;
+	PropagateConstPtr<Impl> m_impl;
+};
+
 }
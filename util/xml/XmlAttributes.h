@@ -1,6 +1,7 @@
 #pragma once
 
 class QString;
+class QStringView;
 
 namespace HomeCompa::Util
 {
@@ -13,6 +14,11 @@ public:
 	virtual size_t  GetCount() const                       = 0;
 	virtual QString GetName(size_t index) const            = 0;
 	virtual QString GetValue(size_t index) const           = 0;
+
+	// views over the parser buffers, valid during the callback only
+	virtual QStringView GetAttributeView(QStringView key) const = 0;
+	virtual QStringView GetNameView(size_t index) const         = 0;
+	virtual QStringView GetValueView(size_t index) const        = 0;
 };
 
 }
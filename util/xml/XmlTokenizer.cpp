@@ -0,0 +1,876 @@
+#include "XmlTokenizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+
+#include "QtTypes.h"
+#include "XmlAttributes.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XML_TOKENIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace HomeCompa::Util;
+
+namespace
+{
+
+constexpr int64_t MIN_CHUNK_SIZE      = 4 * 1024;
+constexpr int64_t MAX_CHUNK_SIZE      = 64 * 1024;
+constexpr size_t  PROLOG_SIZE_LIMIT   = 64 * 1024;
+constexpr size_t  MAX_ENTITY_LENGTH   = 12; // &#x10FFFF; with some reserve
+constexpr auto    ACTUAL_ENCODING     = u"UTF-8";
+constexpr auto    NPOS                = std::string_view::npos;
+constexpr auto    UNEXPECTED_EOF_TEXT = "unexpected end of input";
+
+enum class TextMode
+{
+	Text,      // entities and line ends
+	Attribute, // entities and whitespace normalization
+	Raw,       // line ends only: names, CDATA sections, processing instructions
+};
+
+bool IsSpace(const char ch) noexcept
+{
+	return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+bool IsNameEnd(const char ch) noexcept
+{
+	return IsSpace(ch) || ch == '/' || ch == '>' || ch == '=' || ch == '?';
+}
+
+/// ASCII name characters are checked only, the others come from UTF-8 text decoding
+bool IsName(const std::string_view name) noexcept
+{
+	const auto isNameChar = [](const char ch) {
+		return static_cast<unsigned char>(ch) >= 0x80 || std::isalnum(static_cast<unsigned char>(ch)) || ch == '_' || ch == ':' || ch == '-' || ch == '.';
+	};
+
+	return !name.empty() && std::ranges::all_of(name, isNameChar) && !std::isdigit(static_cast<unsigned char>(name.front())) && name.front() != '-' && name.front() != '.';
+}
+
+bool IsXmlChar(const char32_t ch) noexcept
+{
+	return ch == 0x9 || ch == 0xA || ch == 0xD || (ch >= 0x20 && ch <= 0xD7FF) || (ch >= 0xE000 && ch <= 0xFFFD) || (ch >= 0x10000 && ch <= 0x10FFFF);
+}
+
+bool IsEqualIgnoreCase(const std::string_view lhs, const std::string_view rhs) noexcept
+{
+	return std::ranges::equal(lhs, rhs, [](const char l, const char r) {
+		return std::tolower(static_cast<unsigned char>(l)) == std::tolower(static_cast<unsigned char>(r));
+	});
+}
+
+std::string_view TrimLeft(std::string_view text) noexcept
+{
+	while (!text.empty() && IsSpace(text.front()))
+		text.remove_prefix(1);
+	return text;
+}
+
+std::string_view TrimRight(std::string_view text) noexcept
+{
+	while (!text.empty() && IsSpace(text.back()))
+		text.remove_suffix(1);
+	return text;
+}
+
+struct XmlDecl
+{
+	std::string_view version;
+	std::string_view encoding;
+	std::string_view standalone;
+};
+
+/// pseudo attributes between "<?xml" and "?>"
+std::optional<XmlDecl> ReadXmlDecl(std::string_view text)
+{
+	XmlDecl result;
+	while (!(text = TrimLeft(text)).empty())
+	{
+		const auto eq = text.find('=');
+		if (eq == NPOS)
+			return std::nullopt;
+
+		const auto name = TrimRight(text.substr(0, eq));
+		text            = TrimLeft(text.substr(eq + 1));
+		if (text.empty() || (text.front() != '"' && text.front() != '\''))
+			return std::nullopt;
+
+		const auto close = text.find(text.front(), 1);
+		if (close == NPOS)
+			return std::nullopt;
+
+		const auto value = text.substr(1, close - 1);
+		text             = text.substr(close + 1);
+
+		if (name == "version")
+			result.version = value;
+		else if (name == "encoding")
+			result.encoding = value;
+		else if (name == "standalone")
+			result.standalone = value;
+		else
+			return std::nullopt;
+	}
+
+	if (result.version.empty())
+		return std::nullopt;
+
+	return result;
+}
+
+std::u16string ToU16(const std::string_view text)
+{
+	return { text.begin(), text.end() };
+}
+
+class XmlAttributesImpl final : public XmlAttributes
+{
+	struct Item
+	{
+		std::u16string name;
+		std::u16string value;
+	};
+
+public:
+	void Clear() noexcept
+	{
+		m_count = 0;
+	}
+
+	/// the strings of the previous elements are reused, clear() keeps the capacity
+	Item& Add()
+	{
+		if (m_count == m_items.size())
+			m_items.emplace_back();
+
+		auto& item = m_items[m_count++];
+		item.name.clear();
+		item.value.clear();
+		return item;
+	}
+
+	bool Contains(const std::u16string& name) const noexcept
+	{
+		return std::any_of(m_items.cbegin(), m_items.cbegin() + static_cast<std::ptrdiff_t>(m_count), [&](const Item& item) {
+			return item.name == name;
+		});
+	}
+
+private: // XmlAttributes
+	QString GetAttribute(const QString& key) const override
+	{
+		return GetAttributeView(key).toString();
+	}
+
+	size_t GetCount() const override
+	{
+		return m_count;
+	}
+
+	QString GetName(const size_t index) const override
+	{
+		return GetNameView(index).toString();
+	}
+
+	QString GetValue(const size_t index) const override
+	{
+		return GetValueView(index).toString();
+	}
+
+	QStringView GetAttributeView(const QStringView key) const override
+	{
+		for (size_t i = 0; i < m_count; ++i)
+			if (QStringView(m_items[i].name) == key)
+				return QStringView(m_items[i].value);
+		return {};
+	}
+
+	QStringView GetNameView(const size_t index) const override
+	{
+		assert(index < m_count);
+		return QStringView(m_items[index].name);
+	}
+
+	QStringView GetValueView(const size_t index) const override
+	{
+		assert(index < m_count);
+		return QStringView(m_items[index].value);
+	}
+
+private:
+	std::vector<Item> m_items;
+	size_t            m_count { 0 };
+};
+
+} // namespace
+
+class XmlTokenizer::Impl
+{
+public:
+	Impl(QIODevice& source, const int64_t maxChunkSize)
+		: m_source { source }
+		, m_chunkSize { std::clamp(maxChunkSize, MIN_CHUNK_SIZE, MAX_CHUNK_SIZE) }
+	{
+	}
+
+	bool CanParse()
+	{
+		assert(m_pos == 0 && m_offset == 0);
+
+		if (!Ensure(4))
+			return false;
+
+		size_t pos = 0;
+		if (StartsWith(pos, "\xEF\xBB\xBF"))
+			pos += 3;
+
+		if (StartsWith(pos, "<?xml") && Ensure(pos + 6) && IsSpace(m_buffer[pos + 5]))
+		{
+			const auto end = Find("?>", pos + 5);
+			if (end == NPOS)
+				return false;
+
+			const auto decl = ReadXmlDecl(View(pos + 5, end));
+			if (!decl || decl->version != "1.0")
+				return false;
+
+			if (!decl->encoding.empty() && !IsEqualIgnoreCase(decl->encoding, "UTF-8") && !IsEqualIgnoreCase(decl->encoding, "UTF8"))
+				return false;
+
+			pos = end + 2;
+		}
+
+		while (m_buffer.size() < PROLOG_SIZE_LIMIT)
+		{
+			while (Ensure(pos + 1) && IsSpace(m_buffer[pos]))
+				++pos;
+
+			if (!Ensure(pos + 2) || m_buffer[pos] != '<')
+				return false;
+
+			const auto [prefix, suffix] = StartsWith(pos, "<!--") ? std::pair { "<!--", "-->" } : StartsWith(pos, "<?") ? std::pair { "<?", "?>" } : std::pair { "", "" };
+			if (!*prefix)
+				return m_buffer[pos + 1] != '!';
+
+			const auto end = Find(suffix, pos + strlen(prefix));
+			if (end == NPOS)
+				return false;
+
+			pos = end + strlen(suffix);
+		}
+
+		return false;
+	}
+
+	QByteArray TakeBuffer()
+	{
+		assert(m_pos == 0 && m_offset == 0);
+		QByteArray result(m_buffer.data(), static_cast<qsizetype_t>(m_buffer.size()));
+		m_buffer.clear();
+		return result;
+	}
+
+	void Parse(IHandler& handler)
+	{
+		m_handler = &handler;
+
+		if (StartsWith(0, "\xEF\xBB\xBF"))
+			m_pos += 3;
+
+		if (StartsWith(0, "<?xml") && Ensure(6) && IsSpace(Data()[5]) && !ParseXmlDecl())
+			return;
+
+		while (!m_failed && !handler.IsStopped() && Ensure(1))
+		{
+			if (*Data() != '<')
+			{
+				ParseText();
+				continue;
+			}
+
+			if (!Ensure(2))
+				return Error(UNEXPECTED_EOF_TEXT);
+
+			switch (Data()[1])
+			{
+				case '/':
+					ParseEndTag();
+					break;
+				case '?':
+					ParseProcessingInstruction();
+					break;
+				case '!':
+					ParseMarkup();
+					break;
+				default:
+					ParseStartTag();
+			}
+		}
+
+		if (!m_failed && !handler.IsStopped() && !m_rootClosed)
+			Error(m_depth ? UNEXPECTED_EOF_TEXT : "the document has no root element");
+	}
+
+private:
+	bool ParseXmlDecl()
+	{
+		const auto end  = Find("?>", 5);
+		const auto decl = end == NPOS ? std::nullopt : ReadXmlDecl(View(m_pos + 5, m_pos + end));
+		if (!decl)
+			return Error("invalid XML declaration"), false;
+
+		m_pos += end + 2;
+		m_handler->OnXMLDecl(ToU16(decl->version).data(), ToU16(decl->encoding).data(), ToU16(decl->standalone).data(), ACTUAL_ENCODING);
+		return true;
+	}
+
+	void ParseStartTag()
+	{
+		if (m_rootClosed)
+			return Error("only comments and processing instructions are allowed after the root element");
+
+		auto end = FindTagEnd();
+		if (end == NPOS)
+			return Error(UNEXPECTED_EOF_TEXT);
+
+		const auto* begin   = Data();
+		const auto  isEmpty = begin[end - 1] == '/';
+		const auto* tagEnd  = begin + end - (isEmpty ? 1 : 0);
+
+		const auto* p = std::find_if(begin + 1, tagEnd, IsNameEnd);
+		if (!IsName({ begin + 1, p }))
+			return Error("invalid element name");
+
+		auto& name = PushElement();
+		if (!Decode(begin + 1, p, name, TextMode::Raw))
+			return;
+
+		m_attributes.Clear();
+		while (true)
+		{
+			const auto* attributeBegin = std::find_if_not(p, tagEnd, IsSpace);
+			if (attributeBegin == tagEnd)
+				break;
+
+			if (attributeBegin == p)
+				return Error("whitespace is expected between the attributes");
+
+			const auto* attributeEnd = std::find_if(attributeBegin, tagEnd, IsNameEnd);
+			p                        = std::find_if_not(attributeEnd, tagEnd, IsSpace);
+			if (!IsName({ attributeBegin, attributeEnd }) || p == tagEnd || *p != '=')
+				return Error("invalid attribute");
+
+			p = std::find_if_not(p + 1, tagEnd, IsSpace);
+			if (p == tagEnd || (*p != '"' && *p != '\''))
+				return Error("attribute value is expected in quotes");
+
+			const auto* valueEnd = std::find(p + 1, tagEnd, *p);
+			assert(valueEnd != tagEnd);
+
+			m_name.clear();
+			if (!Decode(attributeBegin, attributeEnd, m_name, TextMode::Raw))
+				return;
+
+			if (m_attributes.Contains(m_name))
+				return Error(QString("attribute '%1' is already specified").arg(QStringView(m_name)));
+
+			auto& attribute = m_attributes.Add();
+			attribute.name  = m_name;
+			if (!Decode(p + 1, valueEnd, attribute.value, TextMode::Attribute))
+				return;
+
+			p = valueEnd + 1;
+		}
+
+		m_pos += end + 1;
+		m_handler->OnStartElement(name.data(), m_attributes);
+
+		if (isEmpty && !m_handler->IsStopped())
+			PopElement();
+	}
+
+	void ParseEndTag()
+	{
+		const auto end = Find(">", 2);
+		if (end == NPOS)
+			return Error(UNEXPECTED_EOF_TEXT);
+
+		const auto view = TrimRight(View(m_pos + 2, m_pos + end));
+		if (!IsName(view))
+			return Error("invalid element name");
+
+		m_name.clear();
+		if (!Decode(view.data(), view.data() + view.size(), m_name, TextMode::Raw))
+			return;
+
+		if (!m_depth || m_elements[m_depth - 1] != m_name)
+			return Error(m_depth ? QString("expected end of tag '%1'").arg(QStringView(m_elements[m_depth - 1])) : QString("unexpected end tag"));
+
+		m_pos += end + 1;
+		PopElement();
+	}
+
+	void ParseProcessingInstruction()
+	{
+		const auto end = Find("?>", 2);
+		if (end == NPOS)
+			return Error(UNEXPECTED_EOF_TEXT);
+
+		const auto text   = View(m_pos + 2, m_pos + end);
+		const auto target = text.substr(0, static_cast<size_t>(std::find_if(text.begin(), text.end(), IsSpace) - text.begin()));
+		const auto data   = TrimLeft(text.substr(target.size()));
+		if (!IsName(target) || IsEqualIgnoreCase(target, "xml"))
+			return Error("invalid processing instruction");
+
+		m_name.clear();
+		m_text.clear();
+		if (!Decode(target.data(), target.data() + target.size(), m_name, TextMode::Raw) || !Decode(data.data(), data.data() + data.size(), m_text, TextMode::Raw))
+			return;
+
+		m_pos += end + 2;
+		m_handler->OnProcessingInstruction(m_name.data(), m_text.data());
+	}
+
+	void ParseMarkup()
+	{
+		if (StartsWith(0, "<!--"))
+		{
+			const auto end = Find("-->", 4);
+			if (end == NPOS)
+				return Error(UNEXPECTED_EOF_TEXT);
+
+			m_pos += end + 3;
+			return;
+		}
+
+		if (!StartsWith(0, "<![CDATA["))
+			return Error("unexpected markup declaration");
+
+		if (!m_depth)
+			return Error("CDATA section outside of the root element");
+
+		const auto end = Find("]]>", 9);
+		if (end == NPOS)
+			return Error(UNEXPECTED_EOF_TEXT);
+
+		m_text.clear();
+		if (!Decode(Data() + 9, Data() + end, m_text, TextMode::Raw))
+			return;
+
+		m_pos += end + 3;
+		m_handler->OnCharacters(m_text.data(), m_text.size());
+	}
+
+	/// the text is passed by chunks, a chunk never ends inside an entity, a UTF-8 sequence or a line end pair
+	void ParseText()
+	{
+		while (!m_failed && !m_handler->IsStopped())
+		{
+			const auto* begin     = Data();
+			const auto  available = Available();
+			const auto* lt        = static_cast<const char*>(std::memchr(begin, '<', available));
+			const auto  length    = lt ? static_cast<size_t>(lt - begin) : m_eof ? available : GetSafeLength(begin, available);
+
+			if (length)
+			{
+				m_text.clear();
+				if (!Decode(begin, begin + length, m_text, TextMode::Text))
+					return;
+
+				m_pos += length;
+				if (!OnCharacters())
+					return;
+			}
+
+			if (lt || (!Fill() && !Available()))
+				return;
+		}
+	}
+
+	bool OnCharacters()
+	{
+		if (m_depth)
+			return m_handler->OnCharacters(m_text.data(), m_text.size()), true;
+
+		if (std::ranges::all_of(m_text, [](const char16_t ch) {
+				return ch < 0x80 && IsSpace(static_cast<char>(ch));
+			}))
+			return true;
+
+		return Error("text is not allowed outside of the root element"), false;
+	}
+
+	/// offset of the tag closing '>' outside of the attribute values
+	size_t FindTagEnd()
+	{
+		char quote = 0;
+		for (size_t i = 1;; ++i)
+		{
+			if (i == Available() && !Fill())
+				return NPOS;
+
+			const auto ch = Data()[i];
+			if (quote)
+			{
+				if (ch == quote)
+					quote = 0;
+			}
+			else if (ch == '"' || ch == '\'')
+			{
+				quote = ch;
+			}
+			else if (ch == '>')
+			{
+				return i;
+			}
+		}
+	}
+
+	bool Decode(const char* p, const char* const end, std::u16string& out, const TextMode mode)
+	{
+		// a UTF-16 string is never longer than its UTF-8 source
+		const auto size = out.size();
+		out.resize(size + static_cast<size_t>(end - p));
+		auto* dst = out.data() + size;
+
+#if defined(XML_TOKENIZER_SSE2)
+		// ASCII without control characters and references is widened 16 bytes at once
+		const auto zero      = _mm_setzero_si128();
+		const auto control   = _mm_set1_epi8(0x20);
+		const auto reference = _mm_set1_epi8(mode == TextMode::Raw ? 0 : '&');
+		const auto lt        = _mm_set1_epi8(mode == TextMode::Attribute ? '<' : 0);
+#endif
+
+		while (p != end)
+		{
+#if defined(XML_TOKENIZER_SSE2)
+			while (end - p >= 16)
+			{
+				const auto bytes   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				const auto special = _mm_or_si128(_mm_cmplt_epi8(bytes, control), _mm_or_si128(_mm_cmpeq_epi8(bytes, reference), _mm_cmpeq_epi8(bytes, lt)));
+				if (const auto mask = static_cast<unsigned>(_mm_movemask_epi8(special)))
+				{
+					for (const auto* ascii = p + std::countr_zero(mask); p != ascii;)
+						*dst++ = static_cast<char16_t>(*p++);
+					break;
+				}
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi8(bytes, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpackhi_epi8(bytes, zero));
+				dst += 16;
+				p   += 16;
+			}
+
+			if (p == end)
+				break;
+#endif
+
+			const auto ch = static_cast<unsigned char>(*p);
+			if (ch >= 0x80)
+			{
+				if (!DecodeUtf8(p, end, dst))
+					return Error("invalid UTF-8 sequence"), false;
+				continue;
+			}
+
+			if (ch == '&' && mode != TextMode::Raw)
+			{
+				if (!DecodeReference(p, end, dst))
+					return false;
+				continue;
+			}
+
+			++p;
+			switch (ch)
+			{
+				case '\r':
+					if (p != end && *p == '\n')
+						++p;
+					*dst++ = mode == TextMode::Attribute ? u' ' : u'\n';
+					break;
+
+				case '\n':
+				case '\t':
+					*dst++ = mode == TextMode::Attribute ? u' ' : static_cast<char16_t>(ch);
+					break;
+
+				case '<':
+					if (mode == TextMode::Attribute)
+						return Error("'<' is not allowed in attribute values"), false;
+					*dst++ = static_cast<char16_t>(ch);
+					break;
+
+				default:
+					if (ch < 0x20)
+						return Error("invalid character"), false;
+					*dst++ = static_cast<char16_t>(ch);
+			}
+		}
+
+		out.resize(static_cast<size_t>(dst - out.data()));
+		return true;
+	}
+
+	static bool DecodeUtf8(const char*& p, const char* const end, char16_t*& dst) noexcept
+	{
+		const auto lead = static_cast<unsigned char>(*p);
+		const auto size = lead < 0xC2 ? 0 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : lead < 0xF5 ? 4 : 0;
+		if (!size || end - p < size)
+			return false;
+
+		char32_t ch = lead & (0x7F >> size);
+		for (int i = 1; i < size; ++i)
+		{
+			const auto next = static_cast<unsigned char>(p[i]);
+			if ((next & 0xC0) != 0x80)
+				return false;
+			ch = ch << 6 | (next & 0x3F);
+		}
+
+		if ((size == 3 && ch < 0x800) || (size == 4 && ch < 0x10000) || !IsXmlChar(ch))
+			return false;
+
+		p += size;
+		Append(ch, dst);
+		return true;
+	}
+
+	bool DecodeReference(const char*& p, const char* const end, char16_t*& dst)
+	{
+		const auto* limit     = p + std::min(static_cast<size_t>(end - p), MAX_ENTITY_LENGTH);
+		const auto* semicolon = std::find(p + 1, limit, ';');
+		if (semicolon == limit)
+			return Error("invalid entity reference"), false;
+
+		const std::string_view name(p + 1, static_cast<size_t>(semicolon - p - 1));
+		p = semicolon + 1;
+
+		if (name.size() > 1 && name.front() == '#')
+		{
+			const auto isHex  = name[1] == 'x';
+			const auto digits = name.substr(isHex ? 2 : 1);
+			char32_t   ch     = 0;
+			for (const auto digit : digits)
+			{
+				const auto value = digit >= '0' && digit <= '9' ? digit - '0' : isHex && std::isxdigit(static_cast<unsigned char>(digit)) ? std::tolower(digit) - 'a' + 10 : -1;
+				if (value < 0 || ch > 0x10FFFF)
+					return Error("invalid character reference"), false;
+				ch = ch * (isHex ? 16 : 10) + static_cast<char32_t>(value);
+			}
+
+			if (digits.empty() || !IsXmlChar(ch))
+				return Error("invalid character reference"), false;
+
+			Append(ch, dst);
+			return true;
+		}
+
+		static constexpr std::pair<std::string_view, char16_t> ENTITIES[] {
+			{   "lt", u'<' },
+			{   "gt", u'>' },
+			{  "amp", u'&' },
+			{ "quot", u'"' },
+			{ "apos", u'\'' },
+		};
+
+		const auto it = std::ranges::find(ENTITIES, name, &std::pair<std::string_view, char16_t>::first);
+		if (it == std::end(ENTITIES))
+			return Error(QString("undefined entity '%1'").arg(QString::fromUtf8(name.data(), static_cast<qsizetype_t>(name.size())))), false;
+
+		*dst++ = it->second;
+		return true;
+	}
+
+	static void Append(const char32_t ch, char16_t*& dst) noexcept
+	{
+		if (ch < 0x10000)
+		{
+			*dst++ = static_cast<char16_t>(ch);
+			return;
+		}
+
+		*dst++ = static_cast<char16_t>(0xD800 + ((ch - 0x10000) >> 10));
+		*dst++ = static_cast<char16_t>(0xDC00 + ((ch - 0x10000) & 0x3FF));
+	}
+
+	/// the available text length without an unfinished entity, UTF-8 sequence or "\r" of "\r\n" at its end
+	static size_t GetSafeLength(const char* begin, size_t length) noexcept
+	{
+		const std::string_view tail(begin + length - std::min(length, MAX_ENTITY_LENGTH), std::min(length, MAX_ENTITY_LENGTH));
+		if (const auto amp = tail.rfind('&'); amp != NPOS && tail.find(';', amp) == NPOS)
+			length -= tail.size() - amp;
+
+		size_t lead = length;
+		while (lead > 0 && length - lead < 3 && (static_cast<unsigned char>(begin[lead - 1]) & 0xC0) == 0x80)
+			--lead;
+		if (lead > 0 && static_cast<unsigned char>(begin[lead - 1]) >= 0xC0)
+		{
+			const auto c    = static_cast<unsigned char>(begin[lead - 1]);
+			const auto size = c < 0xE0 ? 2u : c < 0xF0 ? 3u : 4u;
+			if (length - (lead - 1) < size)
+				length = lead - 1;
+		}
+
+		if (length > 0 && begin[length - 1] == '\r')
+			--length;
+
+		return length;
+	}
+
+	std::u16string& PushElement()
+	{
+		if (m_depth == m_elements.size())
+			m_elements.emplace_back();
+
+		auto& name = m_elements[m_depth++];
+		name.clear();
+		return name;
+	}
+
+	void PopElement()
+	{
+		assert(m_depth > 0);
+		m_handler->OnEndElement(m_elements[m_depth - 1].data());
+		if (--m_depth == 0)
+			m_rootClosed = true;
+	}
+
+	void Error(const QString& text)
+	{
+		size_t line = m_line, lineStart = m_lineStart;
+		for (size_t i = 0; i < m_pos; ++i)
+			if (m_buffer[i] == '\n')
+				++line, lineStart = m_offset + i + 1;
+
+		m_failed = true;
+		m_handler->OnFatalError(line, m_offset + m_pos - lineStart + 1, text);
+	}
+
+private:
+	const char* Data() const noexcept
+	{
+		return m_buffer.data() + m_pos;
+	}
+
+	size_t Available() const noexcept
+	{
+		return m_buffer.size() - m_pos;
+	}
+
+	std::string_view View(const size_t begin, const size_t end) const noexcept
+	{
+		return { m_buffer.data() + begin, end - begin };
+	}
+
+	bool StartsWith(const size_t offset, const std::string_view prefix)
+	{
+		return Ensure(offset + prefix.size()) && std::string_view(Data() + offset, prefix.size()) == prefix;
+	}
+
+	bool Ensure(const size_t size)
+	{
+		while (Available() < size)
+			if (!Fill())
+				return false;
+		return true;
+	}
+
+	/// offset of the pattern from the current position
+	size_t Find(const std::string_view pattern, size_t from)
+	{
+		while (true)
+		{
+			const std::string_view data(Data(), Available());
+			if (const auto found = data.find(pattern, from); found != NPOS)
+				return found;
+
+			from = std::max(from, data.size() >= pattern.size() ? data.size() - pattern.size() + 1 : 0);
+			if (!Fill())
+				return NPOS;
+		}
+	}
+
+	/// the consumed bytes are dropped, the offsets from the current position stay valid
+	bool Fill()
+	{
+		if (m_eof)
+			return false;
+
+		if (m_pos)
+		{
+			for (size_t i = 0; i < m_pos; ++i)
+				if (m_buffer[i] == '\n')
+					++m_line, m_lineStart = m_offset + i + 1;
+
+			m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(m_pos));
+			m_offset += m_pos;
+			m_pos     = 0;
+		}
+
+		const auto size = m_buffer.size();
+		m_buffer.resize(size + static_cast<size_t>(m_chunkSize));
+		const auto read = m_source.read(m_buffer.data() + size, m_chunkSize);
+		m_buffer.resize(size + static_cast<size_t>(std::max<int64_t>(read, 0)));
+
+		m_eof = read <= 0;
+		return !m_eof;
+	}
+
+private:
+	QIODevice&    m_source;
+	const int64_t m_chunkSize;
+
+	std::vector<char> m_buffer;
+	size_t            m_pos { 0 };
+	size_t            m_offset { 0 };
+	size_t            m_line { 1 };
+	size_t            m_lineStart { 0 };
+	bool              m_eof { false };
+
+	IHandler*                   m_handler { nullptr };
+	std::vector<std::u16string> m_elements;
+	size_t                      m_depth { 0 };
+	bool                        m_rootClosed { false };
+	bool                        m_failed { false };
+
+	// reused between the nodes, clear() keeps the capacity
+	XmlAttributesImpl m_attributes;
+	std::u16string    m_name;
+	std::u16string    m_text;
+};
+
+XmlTokenizer::XmlTokenizer(QIODevice& source, const int64_t maxChunkSize)
+	: m_impl(source, maxChunkSize)
+{
+}
+
+XmlTokenizer::~XmlTokenizer() = default;
+
+bool XmlTokenizer::CanParse()
+{
+	return m_impl->CanParse();
+}
+
+QByteArray XmlTokenizer::TakeBuffer()
+{
+	return m_impl->TakeBuffer();
+}
+
+void XmlTokenizer::Parse(IHandler& handler)
+{
+	m_impl->Parse(handler);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+#include "fnd/NonCopyMovable.h"
+#include "fnd/memory.h"
+
+class QByteArray;
+class QIODevice;
+class QString;
+
+namespace HomeCompa::Util
+{
+
+class XmlAttributes;
+
+/// Non-validating tokenizer for the well-formed UTF-8 documents without a document type declaration.
+/// The events are the ones the Xerces SAX parser gives for such a document.
+class XmlTokenizer
+{
+	NON_COPY_MOVABLE(XmlTokenizer)
+
+public:
+	class IHandler // NOLINT(cppcoreguidelines-special-member-functions)
+	{
+	public:
+		virtual ~IHandler() = default;
+
+		virtual bool IsStopped() const noexcept = 0;
+
+		virtual void OnXMLDecl(const char16_t* version, const char16_t* encoding, const char16_t* standalone, const char16_t* actualEncoding) = 0;
+		virtual void OnProcessingInstruction(const char16_t* target, const char16_t* data)                                                    = 0;
+		virtual void OnStartElement(const char16_t* name, const XmlAttributes& attributes)                                                     = 0;
+		virtual void OnEndElement(const char16_t* name)                                                                                        = 0;
+		virtual void OnCharacters(const char16_t* chars, size_t length)                                                                        = 0;
+		virtual void OnFatalError(size_t line, size_t column, const QString& text)                                                             = 0;
+	};
+
+public:
+	XmlTokenizer(QIODevice& source, int64_t maxChunkSize);
+	~XmlTokenizer();
+
+public:
+	/// reads the prolog, false for another encoding, a document type declaration or anything unexpected
+	bool CanParse();
+
+	/// the bytes read so far, another parser continues with them
+	QByteArray TakeBuffer();
+
+	void Parse(IHandler& handler);
+
+private:
+	class Impl;
+	PropagateConstPtr<Impl> m_impl;
+};
+
+} // namespace HomeCompa::Util
@@ -1,9 +1,13 @@
 #include "XmlWriter.h"
 
+#include <algorithm>
 #include <set>
 #include <stack>
+#include <string_view>
+#include <vector>
 
 #include <QIODevice>
+#include <QString>
 
 #include <xercesc/framework/XMLFormatter.hpp>
 #include <xercesc/util/XMLUniDefs.hpp>
@@ -12,6 +16,11 @@
 
 #include "XmlAttributes.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XML_WRITER_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace HomeCompa::Util;
 using namespace xercesc_3_3;
 
@@ -34,21 +43,278 @@ constexpr XMLCh gXMLDecl2[] = { chDoubleQuote, chQuestion, chCloseAngle, chNull
 // <!DOCTYPE html>
 constexpr XMLCh gHTMLDecl[] = { chOpenAngle, chBang, chLatin_D, chLatin_O, chLatin_C, chLatin_T, chLatin_Y, chLatin_P, chLatin_E, chSpace, chLatin_h, chLatin_t, chLatin_m, chLatin_l, chCloseAngle, chNull };
 
-void XmlStarter(XMLFormatter& formatter)
+constexpr size_t UTF8_BUFFER_SIZE = 64 * 1024;
+constexpr size_t UTF8_SLICE_SIZE  = 4 * 1024; // "&quot;" is the longest output of a code unit
+
+std::u16string_view ToView(const QString& value) noexcept
+{
+	return { reinterpret_cast<const char16_t*>(value.utf16()), static_cast<size_t>(value.size()) };
+}
+
+template <size_t N>
+std::u16string_view ToView(const XMLCh (&value)[N]) noexcept
+{
+	return { value, N - 1 };
+}
+
+class IOutput // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+	virtual ~IOutput() = default;
+
+	virtual const XMLCh* GetEncodingName() const                           = 0;
+	virtual void         Write(std::u16string_view text, XMLFormatter::EscapeFlags escapes) = 0;
+	virtual void         Flush()                                           = 0;
+
+	void Write(const XMLCh ch)
+	{
+		Write(std::u16string_view(&ch, 1), XMLFormatter::NoEscapes);
+	}
+
+	void Write(const std::u16string_view text)
+	{
+		Write(text, XMLFormatter::NoEscapes);
+	}
+};
+
+/// any encoding Xerces knows, transcoded by its formatter
+class XercesOutput final
+	: public IOutput
+	, public XMLFormatTarget
+{
+public:
+	XercesOutput(QIODevice& stream, const char* encoding)
+		: m_stream { stream }
+		, m_formatter(encoding, this, XMLFormatter::NoEscapes, XMLFormatter::UnRep_CharRef)
+	{
+	}
+
+private: // IOutput
+	const XMLCh* GetEncodingName() const override
+	{
+		return m_formatter.getEncodingName();
+	}
+
+	void Write(const std::u16string_view text, const XMLFormatter::EscapeFlags escapes) override
+	{
+		m_formatter.formatBuf(text.data(), text.size(), escapes);
+	}
+
+	void Flush() override
+	{
+	}
+
+private: // XMLFormatTarget
+	void writeChars(const XMLByte* const toWrite, const XMLSize_t count, XMLFormatter* const) override
+	{
+		m_stream.write(reinterpret_cast<const char*>(toWrite), static_cast<qint64>(count));
+	}
+
+private:
+	QIODevice&   m_stream;
+	XMLFormatter m_formatter;
+};
+
+/// UTF-8 escaped and encoded in a single pass into a buffer written to the device by large blocks
+class Utf8Output final : public IOutput
+{
+	// UTF-8
+	static constexpr XMLCh ENCODING_NAME[] = { chLatin_U, chLatin_T, chLatin_F, chDash, chDigit_8, chNull };
+
+public:
+	explicit Utf8Output(QIODevice& stream)
+		: m_stream { stream }
+	{
+		m_buffer.reserve(UTF8_BUFFER_SIZE + 6 * UTF8_SLICE_SIZE);
+	}
+
+	~Utf8Output() override
+	{
+		if (m_stream.isOpen())
+			Flush();
+	}
+
+	static bool IsSupported(const char* encoding) noexcept
+	{
+		return std::ranges::any_of(std::initializer_list<std::string_view> { "utf-8", "utf8" }, [encoding = std::string_view(encoding)](const std::string_view name) {
+			return std::ranges::equal(encoding, name, [](const char lhs, const char rhs) {
+				return std::tolower(static_cast<unsigned char>(lhs)) == rhs;
+			});
+		});
+	}
+
+private: // IOutput
+	const XMLCh* GetEncodingName() const override
+	{
+		return ENCODING_NAME;
+	}
+
+	void Write(std::u16string_view text, const XMLFormatter::EscapeFlags escapes) override
+	{
+		while (!text.empty())
+		{
+			// a surrogate pair is never split between the slices
+			auto size = std::min(text.size(), UTF8_SLICE_SIZE);
+			if (size < text.size() && text[size - 1] >= 0xD800 && text[size - 1] < 0xDC00)
+				++size;
+
+			if (m_buffer.size() > UTF8_BUFFER_SIZE)
+				Flush();
+
+			Encode(text.substr(0, size), escapes);
+			text.remove_prefix(size);
+		}
+	}
+
+	void Flush() override
+	{
+		if (m_buffer.empty())
+			return;
+
+		m_stream.write(m_buffer.data(), static_cast<qint64>(m_buffer.size()));
+		m_buffer.clear();
+	}
+
+private:
+	/// the XMLFormatter escapes: character references for the line ends and tabs in the attributes, for '\r' in the text
+	static const char* Escape(const char32_t ch, const XMLFormatter::EscapeFlags escapes) noexcept
+	{
+		if (escapes == XMLFormatter::NoEscapes)
+			return nullptr;
+
+		const auto isAttr = escapes == XMLFormatter::AttrEscapes;
+		switch (ch)
+		{
+			case '&':
+				return "&amp;";
+			case '<':
+				return "&lt;";
+			case '>':
+				return isAttr ? nullptr : "&gt;";
+			case '"':
+				return isAttr ? "&quot;" : nullptr;
+			case '\n':
+				return isAttr ? "&#xA;" : nullptr;
+			case '\t':
+				return isAttr ? "&#x9;" : nullptr;
+			case '\r':
+				return "&#xD;";
+			default:
+				return nullptr;
+		}
+	}
+
+	void Encode(const std::u16string_view text, const XMLFormatter::EscapeFlags escapes)
+	{
+		const auto size = m_buffer.size();
+		m_buffer.resize(size + 6 * text.size());
+		auto* dst = m_buffer.data() + size;
+
+		const auto* p   = text.data();
+		const auto* end = p + text.size();
+
+#if defined(XML_WRITER_SSE2)
+		// ASCII without control and markup characters is narrowed 8 code units at once
+		const auto nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+		const auto control  = _mm_set1_epi16(0x20);
+		const auto amp      = _mm_set1_epi16('&');
+		const auto lt       = _mm_set1_epi16('<');
+		const auto gt       = _mm_set1_epi16('>');
+		const auto quot     = _mm_set1_epi16('"');
+		const auto zero     = _mm_setzero_si128();
+#endif
+
+		while (p != end)
+		{
+#if defined(XML_WRITER_SSE2)
+			for (; end - p >= 8; p += 8, dst += 8)
+			{
+				const auto units   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				const auto markup  = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(units, amp), _mm_cmpeq_epi16(units, lt)), _mm_or_si128(_mm_cmpeq_epi16(units, gt), _mm_cmpeq_epi16(units, quot)));
+				const auto special = _mm_or_si128(markup, _mm_cmplt_epi16(units, control));
+				const auto clean   = _mm_andnot_si128(special, _mm_cmpeq_epi16(_mm_and_si128(units, nonAscii), zero));
+				if (_mm_movemask_epi8(clean) != 0xFFFF)
+					break;
+
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(units, units));
+			}
+
+			if (p == end)
+				break;
+#endif
+
+			const char32_t ch = *p++;
+			if (ch < 0x80)
+			{
+				const auto* escaped = Escape(ch, escapes);
+				if (!escaped)
+				{
+					*dst++ = static_cast<char>(ch);
+					continue;
+				}
+
+				while (*escaped)
+					*dst++ = *escaped++;
+				continue;
+			}
+
+			if (ch < 0x800)
+			{
+				*dst++ = static_cast<char>(0xC0 | ch >> 6);
+				*dst++ = static_cast<char>(0x80 | (ch & 0x3F));
+				continue;
+			}
+
+			if (ch >= 0xD800 && ch < 0xDC00 && p != end && *p >= 0xDC00 && *p < 0xE000)
+			{
+				const auto codePoint = 0x10000 + ((ch - 0xD800) << 10) + (*p++ - 0xDC00);
+				*dst++               = static_cast<char>(0xF0 | codePoint >> 18);
+				*dst++               = static_cast<char>(0x80 | (codePoint >> 12 & 0x3F));
+				*dst++               = static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+				*dst++               = static_cast<char>(0x80 | (codePoint & 0x3F));
+				continue;
+			}
+
+			// an unpaired surrogate is replaced
+			const auto codePoint = ch >= 0xD800 && ch < 0xE000 ? char32_t { 0xFFFD } : ch;
+			*dst++               = static_cast<char>(0xE0 | codePoint >> 12);
+			*dst++               = static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+			*dst++               = static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+
+		m_buffer.resize(static_cast<size_t>(dst - m_buffer.data()));
+	}
+
+private:
+	QIODevice&        m_stream;
+	std::vector<char> m_buffer;
+};
+
+std::unique_ptr<IOutput> CreateOutput(QIODevice& stream, const char* encoding)
 {
-	formatter << gXMLDecl1 << formatter.getEncodingName() << gXMLDecl2;
+	if (Utf8Output::IsSupported(encoding))
+		return std::make_unique<Utf8Output>(stream);
+
+	return std::make_unique<XercesOutput>(stream, encoding);
 }
 
-void HtmlStarter(XMLFormatter& formatter)
+void XmlStarter(IOutput& output)
 {
-	formatter << gHTMLDecl;
+	output.Write(ToView(gXMLDecl1));
+	output.Write(output.GetEncodingName());
+	output.Write(ToView(gXMLDecl2));
 }
 
-void HeadlessStarter(XMLFormatter&)
+void HtmlStarter(IOutput& output)
 {
+	output.Write(ToView(gHTMLDecl));
 }
 
-constexpr std::pair<XmlWriter::Type, void (*)(XMLFormatter&)> STARTERS[] {
+void HeadlessStarter(IOutput&)
+{
+}
+
+constexpr std::pair<XmlWriter::Type, void (*)(IOutput&)> STARTERS[] {
 	{	  XmlWriter::Type::Xml,      &XmlStarter },
 	{     XmlWriter::Type::Html,     &HtmlStarter },
 	{ XmlWriter::Type::Headless, &HeadlessStarter },
@@ -56,25 +322,30 @@ constexpr std::pair<XmlWriter::Type, void (*)(XMLFormatter&)> STARTERS[] {
 
 } // namespace
 
-class XmlWriter::Impl final : public XMLFormatTarget
+class XmlWriter::Impl
 {
 public:
 	Impl(QIODevice& stream, const Options& options)
-		: m_stream { stream }
-		, m_indented { options.indented }
-		, m_formatter(options.encoding, this, XMLFormatter::NoEscapes, XMLFormatter::UnRep_CharRef)
+		: m_indented { options.indented }
+		, m_output { CreateOutput(stream, options.encoding) }
 	{
 		if (stream.isOpen())
-			FindSecond(STARTERS, options.type)(m_formatter);
+			FindSecond(STARTERS, options.type)(*m_output);
 	}
 
 	void WriteProcessingInstruction(const QString& target, const QString& data)
 	{
-		m_formatter << chLF << XMLFormatter::NoEscapes << gStartPI << target.toStdU16String().data();
+		m_output->Write(chLF);
+		m_output->Write(ToView(gStartPI));
+		m_output->Write(ToView(target));
 		if (!data.isEmpty())
-			m_formatter << chSpace << data.toStdU16String().data();
+		{
+			m_output->Write(chSpace);
+			m_output->Write(ToView(data));
+		}
 
-		m_formatter << XMLFormatter::NoEscapes << gEndPI;
+		m_output->Write(ToView(gEndPI));
+		m_output->Flush();
 	}
 
 	void WriteStartElement(const QString& name)
@@ -83,7 +354,8 @@ public:
 		BreakLine(name);
 		m_elements.emplace(name);
 
-		m_formatter << XMLFormatter::NoEscapes << chOpenAngle << name.toStdU16String().data();
+		m_output->Write(chOpenAngle);
+		m_output->Write(ToView(name));
 
 		m_tagOpened = true;
 
@@ -96,8 +368,7 @@ public:
 		WriteStartElement(name);
 
 		for (size_t i = 0, attributeCount = attributes.GetCount(); i < attributeCount; ++i)
-			m_formatter << XMLFormatter::NoEscapes << chSpace << attributes.GetName(i).toStdU16String().data() << chEqual << chDoubleQuote << XMLFormatter::AttrEscapes
-						<< attributes.GetValue(i).toStdU16String().data() << XMLFormatter::NoEscapes << chDoubleQuote;
+			WriteAttribute(attributes.GetNameView(i), attributes.GetValueView(i));
 	}
 
 	void WriteEndElement()
@@ -107,13 +378,16 @@ public:
 		m_elements.pop();
 		if (m_tagOpened)
 		{
-			m_formatter << XMLFormatter::NoEscapes << chForwardSlash << chCloseAngle;
+			m_output->Write(chForwardSlash);
+			m_output->Write(chCloseAngle);
 			m_tagOpened = false;
 		}
 		else
 		{
 			BreakLine(name);
-			m_formatter << XMLFormatter::NoEscapes << gEndElement << name.toStdU16String().data() << chCloseAngle;
+			m_output->Write(ToView(gEndElement));
+			m_output->Write(ToView(name));
+			m_output->Write(chCloseAngle);
 		}
 
 		if (m_characterDepth == m_elements.size() + 1)
@@ -121,12 +395,20 @@ public:
 
 		if (m_unbreakableTags.contains(name))
 			--m_unbreakableCount;
+
+		// the document is complete, the device gets it before the writer is gone as it did without the buffer
+		if (m_elements.empty())
+			m_output->Flush();
 	}
 
-	void WriteAttribute(const QString& name, const QString& value)
+	void WriteAttribute(const QStringView name, const QStringView value)
 	{
-		m_formatter << XMLFormatter::NoEscapes << chSpace << name.toStdU16String().data() << chEqual << chDoubleQuote << XMLFormatter::AttrEscapes << value.toStdU16String().data() << XMLFormatter::NoEscapes
-					<< chDoubleQuote;
+		m_output->Write(chSpace);
+		m_output->Write({ reinterpret_cast<const char16_t*>(name.utf16()), static_cast<size_t>(name.size()) });
+		m_output->Write(chEqual);
+		m_output->Write(chDoubleQuote);
+		m_output->Write({ reinterpret_cast<const char16_t*>(value.utf16()), static_cast<size_t>(value.size()) }, XMLFormatter::AttrEscapes);
+		m_output->Write(chDoubleQuote);
 	}
 
 	void WriteCharacters(const QString& data)
@@ -135,8 +417,7 @@ public:
 			return;
 
 		CloseTag();
-		const auto chars = data.toStdU16String();
-		m_formatter.formatBuf(chars.data(), chars.length(), XMLFormatter::CharEscapes);
+		m_output->Write(ToView(data), XMLFormatter::CharEscapes);
 
 		if (!m_characterDepth)
 			m_characterDepth = m_elements.size();
@@ -147,14 +428,13 @@ public:
 		if (!m_tagOpened)
 			return;
 
-		m_formatter << XMLFormatter::NoEscapes << chCloseAngle;
+		m_output->Write(chCloseAngle);
 		m_tagOpened = false;
 	}
 
-private: // XMLFormatTarget
-	void writeChars(const XMLByte* const toWrite, const XMLSize_t count, XMLFormatter* const) override
+	void Flush()
 	{
-		m_stream.write(reinterpret_cast<const char*>(toWrite), static_cast<qint64>(count));
+		m_output->Flush();
 	}
 
 private:
@@ -165,16 +445,15 @@ private:
 
 		m_lastElement = name;
 
-		m_formatter << chLF;
+		m_output->Write(chLF);
 		for (size_t i = 0, sz = m_elements.size(); i < sz; ++i)
-			m_formatter << chHTab;
+			m_output->Write(chHTab);
 	}
 
 private:
-	QIODevice&          m_stream;
-	const bool          m_indented;
-	XMLFormatter        m_formatter;
-	std::stack<QString> m_elements;
+	const bool               m_indented;
+	std::unique_ptr<IOutput> m_output;
+	std::stack<QString>      m_elements;
 	bool                m_tagOpened { false };
 	QString             m_lastElement;
 	size_t              m_characterDepth { 0 };
@@ -232,6 +511,12 @@ XmlWriter& XmlWriter::CloseTag()
 	return *this;
 }
 
+XmlWriter& XmlWriter::Flush()
+{
+	m_impl->Flush();
+	return *this;
+}
+
 XmlWriter::XmlNodeGuard XmlWriter::Guard(const QString& name)
 {
 	return XmlNodeGuard { *this, name };
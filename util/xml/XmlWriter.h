@@ -97,6 +97,10 @@ public:
 	XmlWriter& WriteCharacters(const QString& data);
 	XmlWriter& CloseTag();
 
+	/// the UTF-8 output is buffered, the buffer is written to the stream when the root element or a processing instruction is written,
+	/// by the destructor if the stream is still open, and here for the partial output
+	XmlWriter& Flush();
+
 	XmlNodeGuard Guard(const QString& name);
 
 private:
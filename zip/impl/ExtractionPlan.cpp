@@ -0,0 +1,175 @@
+#include "ExtractionPlan.h"
+
+#include <algorithm>
+#include <limits>
+#include <ranges>
+#include <unordered_map>
+
+#include <QBuffer>
+#include <QDir>
+#include <QTemporaryDir>
+
+#include "fnd/QIODeviceStreamWrapper.h"
+
+#include "bit7z/bitinputarchive.hpp"
+#include "platform/StrUtil.h"
+#include "zip/interface/error.h"
+
+#include "FileItem.h"
+#include "QtTypes.h"
+#include "log.h"
+
+namespace HomeCompa::ZipDetails::SevenZip
+{
+
+namespace
+{
+
+constexpr auto NO_BLOCK = std::numeric_limits<uint64_t>::max();
+
+/// bounds the temporary files and the wait for the first entry of a block; a batch decodes its block from the start again,
+/// so the bound is large enough for that to stay cheap
+constexpr size_t MAX_BATCH_SIZE = 256 * 1024 * 1024;
+
+/// the entry is found on disk by its name only if the file system keeps the name as is
+bool IsPortable(const QString& name)
+{
+	return std::ranges::none_of(name, [](const QChar ch) {
+		return ch.unicode() < 0x20 || QStringView(u"<>:\"\\|?*").contains(ch);
+	}) && std::ranges::none_of(name.split('/'), [](const QString& part) {
+		return part.isEmpty() || part.endsWith('.') || part.endsWith(' ');
+	});
+}
+
+uint64_t GetBlock(const bit7z::BitInputArchive& archive, const FileItem& item)
+{
+	const auto block = archive.itemProperty(item.index, bit7z::BitProperty::Block);
+	return block.isEmpty() ? NO_BLOCK : block.getUInt64();
+}
+
+QByteArray ExtractItem(const bit7z::BitInputArchive& archive, const FileItem& item)
+{
+	QByteArray body;
+	body.reserve(static_cast<qsizetype_t>(item.size));
+
+	QBuffer buffer(&body);
+	buffer.open(QIODevice::WriteOnly);
+	const auto stream = QStdOStream::create(buffer);
+	archive.extractTo(*stream, item.index);
+
+	return body;
+}
+
+} // namespace
+
+ExtractionPlan::ExtractionPlan(const bit7z::BitInputArchive& archive, std::vector<const FileItem*> items)
+{
+	std::ranges::sort(items, {}, [](const FileItem* item) {
+		return item->index;
+	});
+
+	if (!archive.isSolid())
+	{
+		std::ranges::transform(items, std::back_inserter(m_groups), [](const FileItem* item) {
+			return Group { item };
+		});
+		return;
+	}
+
+	// the blocks are contiguous index ranges, the sorted entries of a block are adjacent
+	std::vector<Group> blocks;
+	auto               currentBlock = NO_BLOCK;
+	for (const auto* item : items)
+	{
+		const auto block = GetBlock(archive, *item);
+		if (block == NO_BLOCK || block != currentBlock || blocks.empty())
+			blocks.emplace_back();
+
+		blocks.back().push_back(item);
+		currentBlock = block;
+	}
+
+	for (const auto& block : blocks)
+		AddBatches(block);
+}
+
+void ExtractionPlan::AddBatches(const Group& block)
+{
+	// the entries the file system may rename or merge are extracted one by one to memory
+	std::unordered_map<QString, size_t> names;
+	for (const auto* item : block)
+		++names[item->name.toCaseFolded()];
+
+	size_t batchSize = 0;
+	Group  batch;
+
+	// the groups stay in archive order: the entries before a single one are flushed first
+	const auto flush = [&] {
+		if (batch.empty())
+			return;
+
+		m_groups.push_back(std::move(batch));
+		batch     = {};
+		batchSize = 0;
+	};
+
+	for (const auto* item : block)
+	{
+		if (names[item->name.toCaseFolded()] > 1 || !IsPortable(item->name))
+		{
+			flush();
+			m_groups.push_back({ item });
+			continue;
+		}
+
+		if (batchSize + item->size > MAX_BATCH_SIZE)
+			flush();
+
+		batch.push_back(item);
+		batchSize += item->size;
+	}
+
+	flush();
+}
+
+size_t ExtractionPlan::GetGroupCount() const noexcept
+{
+	return m_groups.size();
+}
+
+void ExtractionPlan::Extract(const bit7z::BitInputArchive& archive, const size_t group, const Deliver& deliver) const
+{
+	const auto& items = m_groups[group];
+	if (items.size() == 1)
+		return deliver(*items.front(), ExtractItem(archive, *items.front()));
+
+	// bit7z extracts several entries in one pass to a folder only
+	const QTemporaryDir dir;
+	if (!dir.isValid())
+		Error::CannotOpenFile(dir.path());
+
+	archive.extractTo(
+		Platform::StringToPath(dir.path()).native(),
+		items | std::views::transform([](const FileItem* item) {
+			return item->index;
+		}) | std::ranges::to<std::vector<uint32_t>>()
+	);
+
+	for (const auto* item : items)
+	{
+		QFile file(QDir(dir.path()).filePath(item->name));
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			PLOGW << item->name << " is not found in the extracted files, reading it alone";
+			deliver(*item, ExtractItem(archive, *item));
+			continue;
+		}
+
+		auto body = file.readAll();
+		file.close();
+		file.remove();
+		deliver(*item, std::move(body));
+	}
+}
+
+} // namespace HomeCompa::ZipDetails::SevenZip
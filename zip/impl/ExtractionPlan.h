@@ -0,0 +1,46 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+class QByteArray;
+
+namespace bit7z
+{
+
+class BitInputArchive;
+
+}
+
+namespace HomeCompa::ZipDetails::SevenZip
+{
+
+struct FileItem;
+
+/// Requested entries grouped by the solid block they are in, the groups and the entries in a group in archive order.
+/// A group is decoded once: a solid block is decompressed from its start whatever entry is read.
+/// A multi-entry group goes through a temporary folder, so a block is split into batches of bounded size,
+/// and the entries whose names the file system may change are read alone to memory.
+class ExtractionPlan
+{
+public:
+	using Group   = std::vector<const FileItem*>;
+	using Deliver = std::function<void(const FileItem& item, QByteArray body)>;
+
+public:
+	ExtractionPlan(const bit7z::BitInputArchive& archive, std::vector<const FileItem*> items);
+
+public:
+	[[nodiscard]] size_t GetGroupCount() const noexcept;
+
+	/// the archive may be another reader of the same file, one per thread
+	void Extract(const bit7z::BitInputArchive& archive, size_t group, const Deliver& deliver) const;
+
+private:
+	void AddBatches(const Group& block);
+
+private:
+	std::vector<Group> m_groups;
+};
+
+}
@@ -0,0 +1,101 @@
+#include "FileStorageCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "FileItem.h"
+#include "QtTypes.h"
+#include "log.h"
+
+namespace HomeCompa::ZipDetails::SevenZip::FileStorageCache
+{
+
+namespace
+{
+
+constexpr quint32 MAGIC   = 0x495A4C46; // FLZI
+constexpr quint32 VERSION = 1;
+
+constexpr auto DATA_STREAM_VERSION = QDataStream::Qt_5_15;
+
+QString GetCachePath(const QFileInfo& archive)
+{
+	const auto hash = QCryptographicHash::hash(archive.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+	return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath(QString("archive_index/%1.idx").arg(QString::fromLatin1(hash)));
+}
+
+} // namespace
+
+std::optional<FileStorage> Load(const QString& archivePath, const size_t itemCount)
+{
+	const QFileInfo archive(archivePath);
+	QFile           file(GetCachePath(archive));
+	if (!file.open(QIODevice::ReadOnly))
+		return std::nullopt;
+
+	auto* data = file.map(0, file.size());
+	if (!data)
+		return std::nullopt;
+
+	const auto bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data), static_cast<qsizetype_t>(file.size()));
+	QDataStream stream(bytes);
+	stream.setVersion(DATA_STREAM_VERSION);
+
+	quint32   magic = 0, version = 0;
+	QString   path;
+	qint64    size = 0;
+	QDateTime lastModified;
+	quint64   archiveItemCount = 0, count = 0;
+	stream >> magic >> version >> path >> size >> lastModified >> archiveItemCount >> count;
+	if (stream.status() != QDataStream::Ok || magic != MAGIC || version != VERSION || path != archive.absoluteFilePath() || size != archive.size() || lastModified != archive.lastModified()
+	    || archiveItemCount != itemCount)
+		return std::nullopt;
+
+	FileStorage result;
+	result.files.reserve(count);
+	result.index.reserve(count);
+	for (quint64 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+	{
+		FileItem item;
+		quint64  itemSize = 0;
+		stream >> item.index >> item.name >> itemSize >> item.time >> item.isDir;
+		item.size = itemSize;
+		result.index.try_emplace(item.name, result.files.size());
+		result.files.emplace_back(std::move(item));
+	}
+
+	if (stream.status() != QDataStream::Ok)
+	{
+		PLOGW << "broken archive index: " << file.fileName();
+		return std::nullopt;
+	}
+
+	return result;
+}
+
+void Save(const QString& archivePath, const size_t itemCount, const FileStorage& fileStorage)
+{
+	const QFileInfo archive(archivePath);
+	const auto      cachePath = GetCachePath(archive);
+	if (!QDir().mkpath(QFileInfo(cachePath).absolutePath()))
+		return;
+
+	QSaveFile file(cachePath);
+	if (!file.open(QIODevice::WriteOnly))
+		return;
+
+	QDataStream stream(&file);
+	stream.setVersion(DATA_STREAM_VERSION);
+	stream << MAGIC << VERSION << archive.absoluteFilePath() << archive.size() << archive.lastModified() << static_cast<quint64>(itemCount) << static_cast<quint64>(fileStorage.files.size());
+	for (const auto& item : fileStorage.files)
+		stream << item.index << item.name << static_cast<quint64>(item.size) << item.time << item.isDir;
+
+	if (stream.status() != QDataStream::Ok || !file.commit())
+		PLOGW << "cannot write archive index: " << cachePath;
+}
+
+} // namespace HomeCompa::ZipDetails::SevenZip::FileStorageCache
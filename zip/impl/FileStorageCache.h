@@ -0,0 +1,22 @@
+#pragma once
+
+#include <optional>
+
+class QString;
+
+namespace HomeCompa::ZipDetails::SevenZip
+{
+
+struct FileStorage;
+
+/// File list of an archive kept in the cache directory, valid while the archive size and modification time are the same
+namespace FileStorageCache
+{
+
+/// itemCount is the number of archive items, a cheap check the index is for this archive
+std::optional<FileStorage> Load(const QString& archivePath, size_t itemCount);
+void                       Save(const QString& archivePath, size_t itemCount, const FileStorage& fileStorage);
+
+}
+
+}
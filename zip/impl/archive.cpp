@@ -1,13 +1,22 @@
 #include "archive.h"
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <numeric>
 #include <ranges>
 #include <thread>
 
+#include <QFileInfo>
 #include <QVariant>
 
 #include "fnd/FindPair.h"
+#include "fnd/NonCopyMovable.h"
 #include "fnd/QIODeviceStreamWrapper.h"
+#include "fnd/ScopedCall.h"
 #include "fnd/StrUtil.h"
 
 #include "interface/types.h"
@@ -24,6 +33,8 @@
 #include "zip/interface/zip.h"
 
 #include "FileItem.h"
+#include "ExtractionPlan.h"
+#include "FileStorageCache.h"
 #include "QtTypes.h"
 #include "log.h"
 #include "reader.h"
@@ -121,6 +132,173 @@ FileStorage CreateFileList(const bit7z::BitInputArchive& archive)
 	return result;
 }
 
+/// 7z is loaded once per process
+const bit7z::Bit7zLibrary& GetLibrary()
+{
+	static const bit7z::Bit7zLibrary lib;
+	return lib;
+}
+
+/// an archive opened for extraction only, without its file list
+struct ArchiveStream
+{
+	std::ifstream           stream;
+	bit7z::BitArchiveReader archive;
+
+	explicit ArchiveStream(const QString& filename)
+		: stream(Platform::StringToPath(filename), std::ios_base::in | std::ios::binary)
+		, archive(GetLibrary(), stream)
+	{
+	}
+};
+
+/// Open archives shared by the readers of the process. A handle is leased by one reader at a time,
+/// the idle ones are kept in LRU order and evicted by count, by the memory their file lists take and by idle time.
+/// An idle handle keeps its archive file open, so it cannot be renamed or deleted on Windows until the handle is dropped.
+class ArchivePool
+{
+	NON_COPY_MOVABLE(ArchivePool)
+
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr size_t MAX_IDLE_COUNT  = 16;
+	static constexpr size_t MAX_IDLE_MEMORY = 64 * 1024 * 1024;
+	static constexpr auto   MAX_IDLE_TIME   = std::chrono::seconds(30);
+
+public:
+	struct Handle
+	{
+		QString                                  path;
+		qint64                                   size { 0 };
+		QDateTime                                lastModified;
+		std::ifstream                            stream;
+		std::unique_ptr<bit7z::BitArchiveReader> archive;
+		std::shared_ptr<const FileStorage>       files;
+		size_t                                   memory { 0 };
+		Clock::time_point                        released;
+	};
+
+	struct Releaser
+	{
+		void operator()(Handle* handle) const
+		{
+			Instance().Release(std::unique_ptr<Handle>(handle));
+		}
+	};
+
+	using Lease = std::unique_ptr<Handle, Releaser>;
+
+public:
+	static ArchivePool& Instance()
+	{
+		static ArchivePool pool;
+		return pool;
+	}
+
+	Lease Acquire(const QString& filename)
+	{
+		const QFileInfo fileInfo(filename);
+		const auto      path         = fileInfo.absoluteFilePath();
+		const auto      size         = fileInfo.size();
+		const auto      lastModified = fileInfo.lastModified();
+
+		{
+			std::scoped_lock lock(m_guard);
+			DropExpired();
+			const auto it = std::ranges::find(m_idle, path, [](const auto& item) {
+				return item->path;
+			});
+			if (it != m_idle.end())
+			{
+				auto handle = std::move(*it);
+				m_idle.erase(it);
+				m_idleMemory -= handle->memory;
+				if (handle->size == size && handle->lastModified == lastModified)
+					return Lease(handle.release());
+			}
+		}
+
+		auto handle          = std::make_unique<Handle>();
+		handle->path         = path;
+		handle->size         = size;
+		handle->lastModified = lastModified;
+		handle->stream.open(Platform::StringToPath(filename), std::ios_base::in | std::ios::binary);
+		handle->archive = std::make_unique<bit7z::BitArchiveReader>(GetLibrary(), handle->stream);
+
+		const auto itemCount = static_cast<size_t>(handle->archive->itemsCount());
+		if (auto files = FileStorageCache::Load(filename, itemCount))
+		{
+			handle->files = std::make_shared<const FileStorage>(std::move(*files));
+		}
+		else
+		{
+			handle->files = std::make_shared<const FileStorage>(CreateFileList(*handle->archive));
+			FileStorageCache::Save(filename, itemCount, *handle->files);
+		}
+
+		handle->memory = std::accumulate(handle->files->files.cbegin(), handle->files->files.cend(), size_t { 0 }, [](const size_t init, const FileItem& item) {
+			return init + sizeof(FileItem) + 2 * sizeof(void*) + 2 * sizeof(QChar) * static_cast<size_t>(item.name.size());
+		});
+
+		return Lease(handle.release());
+	}
+
+	/// the archive is about to be changed, an empty filename drops all the idle handles
+	void Evict(const QString& filename)
+	{
+		const auto path = filename.isEmpty() ? QString {} : QFileInfo(filename).absoluteFilePath();
+
+		std::scoped_lock lock(m_guard);
+		for (auto it = m_idle.begin(); it != m_idle.end();)
+		{
+			if (!path.isEmpty() && (*it)->path != path)
+			{
+				++it;
+				continue;
+			}
+			m_idleMemory -= (*it)->memory;
+			it            = m_idle.erase(it);
+		}
+	}
+
+private:
+	ArchivePool() = default;
+
+	void Release(std::unique_ptr<Handle> handle)
+	{
+		handle->archive->setTotalCallback({});
+		handle->archive->setProgressCallback({});
+
+		handle->released = Clock::now();
+
+		std::scoped_lock lock(m_guard);
+		m_idleMemory += handle->memory;
+		m_idle.push_front(std::move(handle));
+		while (m_idle.size() > MAX_IDLE_COUNT || (m_idle.size() > 1 && m_idleMemory > MAX_IDLE_MEMORY))
+		{
+			m_idleMemory -= m_idle.back()->memory;
+			m_idle.pop_back();
+		}
+		DropExpired();
+	}
+
+	/// the pool has no timer, the expired handles are dropped whenever it is used
+	void DropExpired()
+	{
+		const auto expired = Clock::now() - MAX_IDLE_TIME;
+		while (!m_idle.empty() && m_idle.back()->released < expired)
+		{
+			m_idleMemory -= m_idle.back()->memory;
+			m_idle.pop_back();
+		}
+	}
+
+private:
+	std::mutex                         m_guard;
+	std::list<std::unique_ptr<Handle>> m_idle;
+	size_t                             m_idleMemory { 0 };
+};
+
 class ZipImpl : virtual public IZip
 {
 protected:
@@ -138,7 +316,7 @@ private: // IZip
 
 	QStringList GetFileNameList() const override
 	{
-		return m_files.files | std::views::filter([](const auto& item) {
+		return m_files->files | std::views::filter([](const auto& item) {
 				   return !item.isDir;
 			   })
 		     | std::views::transform([](const auto& item) {
@@ -149,17 +327,17 @@ private: // IZip
 
 	size_t GetFileSize(const QString& filename) const override
 	{
-		return m_files.GetFile(filename).size;
+		return m_files->GetFile(filename).size;
 	}
 
 	const QDateTime& GetFileTime(const QString& filename) const override
 	{
-		return m_files.GetFile(filename).time;
+		return m_files->GetFile(filename).time;
 	}
 
 	size_t GetFileIndex(const QString& filename) const override
 	{
-		if (const auto it = m_files.index.find(filename); it != m_files.index.end())
+		if (const auto it = m_files->index.find(filename); it != m_files->index.end())
 			return it->second;
 
 		return INVALID_INDEX;
@@ -177,6 +355,12 @@ private: // IZip
 		throw std::runtime_error("Cannot read with writer");
 	}
 
+	void Extract(const QStringList& /*fileNames*/, const ExtractCallback& /*callback*/, unsigned /*threadCount*/) const override
+	{
+		assert(false && "Cannot read with writer");
+		throw std::runtime_error("Cannot read with writer");
+	}
+
 	bool Write(const IZipFileProvider& /*zipFileProvider*/) override
 	{
 		assert(false && "Cannot write with reader");
@@ -190,9 +374,9 @@ private: // IZip
 	}
 
 protected:
-	bit7z::Bit7zLibrary               m_lib;
-	std::shared_ptr<ProgressCallback> m_progress;
-	FileStorage                       m_files;
+	const bit7z::Bit7zLibrary&         m_lib { GetLibrary() };
+	std::shared_ptr<ProgressCallback>  m_progress;
+	std::shared_ptr<const FileStorage> m_files { std::make_shared<const FileStorage>() };
 };
 
 class Reader : public ZipImpl
@@ -213,29 +397,22 @@ protected:
 private: // IZip
 	std::unique_ptr<IFile> Read(const QString& filename) const override
 	{
-		m_archive->setTotalCallback([this](const uint64_t total) {
-			m_progress->OnStartWithTotal(static_cast<int64_t>(total));
-		});
-		m_archive->setProgressCallback([this](const uint64_t progress) {
-			m_progress->OnSetCompleted(static_cast<int64_t>(progress));
-			return !m_progress->OnCheckBreak();
+		SetCallbacks();
+		return File::Read(*m_archive, m_files->GetFile(filename), m_busy, [this] {
+			return CreateThreadReader();
 		});
-		return File::Read(*m_archive, m_files.GetFile(filename));
 	}
 
 	std::unordered_map<QString, QByteArray> ReadAll() const override
 	{
-		m_archive->setTotalCallback([this](const uint64_t total) {
-			m_progress->OnStartWithTotal(static_cast<int64_t>(total));
-		});
-		m_archive->setProgressCallback([this](const uint64_t progress) {
-			m_progress->OnSetCompleted(static_cast<int64_t>(progress));
-			return !m_progress->OnCheckBreak();
-		});
+		const auto busyGuard = LockExtraction();
+
+		SetCallbacks();
 
 #ifdef ADDITIONAL_LOG_ENABLED
 		PLOGV << "extracting...";
 #endif
+		// every entry is wanted, a single pass straight to memory
 		std::map<bit7z::tstring, std::vector<bit7z::byte_t>> output;
 		m_archive->extractTo(output);
 		return output | std::views::transform([](auto& item) {
@@ -247,8 +424,102 @@ private: // IZip
 		     | std::ranges::to<std::unordered_map>();
 	}
 
+	void Extract(const QStringList& fileNames, const ExtractCallback& callback, const unsigned threadCount) const override
+	{
+		Extract(
+			fileNames | std::views::transform([this](const auto& fileName) {
+				return &m_files->GetFile(fileName);
+			})
+				| std::ranges::to<std::vector<const FileItem*>>(),
+			callback,
+			threadCount
+		);
+	}
+
+private:
+	/// another reader of the same archive for an extraction thread or a streamed entry, it may outlive this one
+	virtual std::shared_ptr<const bit7z::BitInputArchive> CreateThreadReader() const = 0;
+
+	void Extract(std::vector<const FileItem*> items, const ExtractCallback& callback, unsigned threadCount) const
+	{
+		const auto busyGuard = LockExtraction();
+
+		const ExtractionPlan plan(*m_archive, std::move(items));
+		threadCount = std::min(threadCount ? threadCount : std::thread::hardware_concurrency(), static_cast<unsigned>(plan.GetGroupCount()));
+
+		std::mutex         callbackGuard;
+		std::atomic_size_t next { 0 };
+		std::atomic_bool   stop { false };
+
+		const auto deliver = [&](const FileItem& item, QByteArray body) {
+			std::scoped_lock lock(callbackGuard);
+			callback(item.name, std::move(body));
+		};
+
+		const auto extractGroups = [&](const bit7z::BitInputArchive& archive) {
+			for (auto i = next++; i < plan.GetGroupCount() && !stop; i = next++)
+				plan.Extract(archive, i, deliver);
+		};
+
+		if (threadCount <= 1)
+		{
+			SetCallbacks();
+			return extractGroups(*m_archive);
+		}
+
+#ifdef ADDITIONAL_LOG_ENABLED
+		PLOGV << "extracting " << plan.GetGroupCount() << " groups in " << threadCount << " threads...";
+#endif
+
+		std::exception_ptr       error;
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount);
+		for (unsigned i = 0; i < threadCount; ++i)
+			threads.emplace_back([&] {
+				try
+				{
+					extractGroups(*CreateThreadReader());
+				}
+				catch (...)
+				{
+					std::scoped_lock lock(callbackGuard);
+					if (!error)
+						error = std::current_exception();
+					stop = true;
+				}
+			});
+
+		std::ranges::for_each(threads, &std::thread::join);
+
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	/// the archive extracts one request at a time
+	ScopedCall LockExtraction() const
+	{
+		if (m_busy.test_and_set())
+			throw std::runtime_error("Archive entry is still being read");
+
+		return ScopedCall([this] {
+			m_busy.clear();
+		});
+	}
+
+	void SetCallbacks() const
+	{
+		m_archive->setTotalCallback([this](const uint64_t total) {
+			m_progress->OnStartWithTotal(static_cast<int64_t>(total));
+		});
+		m_archive->setProgressCallback([this](const uint64_t progress) {
+			m_progress->OnSetCompleted(static_cast<int64_t>(progress));
+			return !m_progress->OnCheckBreak();
+		});
+	}
+
 protected:
-	std::unique_ptr<bit7z::BitArchiveReader> m_archive;
+	bit7z::BitArchiveReader* m_archive { nullptr };
+	mutable std::atomic_flag m_busy;
 };
 
 class ReaderFile : public Reader
@@ -256,33 +527,71 @@ class ReaderFile : public Reader
 public:
 	ReaderFile(const QString& filename, std::shared_ptr<ProgressCallback> progress)
 		: Reader(std::move(progress))
-		, m_stream(Platform::StringToPath(filename), std::ios_base::in | std::ios::binary)
+		, m_handle(ArchivePool::Instance().Acquire(filename))
 	{
-		m_archive = std::make_unique<bit7z::BitArchiveReader>(m_lib, m_stream);
-		m_files   = CreateFileList(*m_archive);
+		m_archive = m_handle->archive.get();
+		m_files   = m_handle->files;
+	}
+
+private: // Reader
+	std::shared_ptr<const bit7z::BitInputArchive> CreateThreadReader() const override
+	{
+		auto        stream  = std::make_shared<ArchiveStream>(m_handle->path);
+		const auto* archive = &stream->archive;
+		return { std::move(stream), archive };
 	}
 
 private:
-	std::ifstream m_stream;
+	ArchivePool::Lease m_handle;
 };
 
 class ReaderStream : public Reader
 {
+	using Bytes = std::vector<bit7z::byte_t>;
+
+	/// the reader refers to the bytes, they are shared with the readers that may outlive this one
+	struct BufferArchive
+	{
+		std::shared_ptr<const Bytes> bytes;
+		bit7z::BitArchiveReader      archive;
+
+		explicit BufferArchive(std::shared_ptr<const Bytes> bytesIn)
+			: bytes { std::move(bytesIn) }
+			, archive(GetLibrary(), *bytes)
+		{
+		}
+	};
+
 public:
 	ReaderStream(QIODevice& stream, std::shared_ptr<ProgressCallback> progress)
 		: Reader(std::move(progress))
 	{
-		if (stream.isReadable())
+		auto bytes = std::make_shared<Bytes>();
+		if (stream.isReadable() && stream.isSequential())
+		{
+			const auto data = stream.readAll();
+			bytes->assign(reinterpret_cast<const bit7z::byte_t*>(data.constData()), reinterpret_cast<const bit7z::byte_t*>(data.constData()) + data.size());
+		}
+		else if (stream.isReadable())
 		{
-			m_bytes.resize(stream.size());
-			stream.read(reinterpret_cast<char*>(m_bytes.data()), static_cast<qint64>(m_bytes.size()));
+			bytes->resize(stream.size());
+			stream.read(reinterpret_cast<char*>(bytes->data()), static_cast<qint64>(bytes->size()));
 		}
-		m_archive = std::make_unique<bit7z::BitArchiveReader>(m_lib, m_bytes);
-		m_files   = CreateFileList(*m_archive);
+		m_reader  = std::make_unique<BufferArchive>(std::move(bytes));
+		m_archive = &m_reader->archive;
+		m_files   = std::make_shared<const FileStorage>(CreateFileList(*m_archive));
+	}
+
+private: // Reader
+	std::shared_ptr<const bit7z::BitInputArchive> CreateThreadReader() const override
+	{
+		auto        reader  = std::make_shared<const BufferArchive>(m_reader->bytes);
+		const auto* archive = &reader->archive;
+		return { std::move(reader), archive };
 	}
 
 protected:
-	std::vector<bit7z::byte_t> m_bytes;
+	std::unique_ptr<BufferArchive> m_reader;
 };
 
 class Writer : public ZipImpl
@@ -331,7 +640,7 @@ protected:
 	void UpdateFileList()
 	{
 		if (const auto* inputArchive = m_archive->toInputArchive())
-			m_files = CreateFileList(*inputArchive);
+			m_files = std::make_shared<const FileStorage>(CreateFileList(*inputArchive));
 	}
 
 private:
@@ -374,6 +683,7 @@ public:
 		: Writer(std::move(progress))
 		, m_filename { std::move(filename) }
 	{
+		ArchivePool::Instance().Evict(m_filename);
 		m_archive = CreateArchive(format, appendMode);
 		SetCallbacks();
 		UpdateFileList();
@@ -396,7 +706,7 @@ private: // IZip
 		if (!editor)
 			throw std::runtime_error("Cannot remove with writer");
 
-		const auto sorted = m_files.files | std::views::transform([](const auto& item) {
+		const auto sorted = m_files->files | std::views::transform([](const auto& item) {
 								auto list = item.name.split('/');
 								return list.size() < 2 ? std::make_pair(item.name, item.name) : std::make_pair(list.front() + '/', item.name);
 							})
@@ -407,7 +717,7 @@ private: // IZip
 		{
 			for (auto [it, end] = sorted.equal_range(fileName); it != end; ++it)
 			{
-				const auto& file = m_files.GetFile(it->second);
+				const auto& file = m_files->GetFile(it->second);
 				editor->deleteItem(file.index, bit7z::DeletePolicy::RecurseDirs);
 				++count;
 			}
@@ -511,6 +821,11 @@ bool Archive::IsArchive(const QString& filename)
 	});
 }
 
+void Archive::DropIdle(const QString& filename)
+{
+	ArchivePool::Instance().Evict(filename);
+}
+
 QStringList Archive::GetTypes()
 {
 	return ARCHIVE_EXTENSIONS | std::views::transform([](const char* item) {
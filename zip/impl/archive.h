@@ -27,6 +27,7 @@ struct Archive
 	static std::unique_ptr<IZip> CreateWriterStream(QIODevice& stream, Format, std::shared_ptr<ProgressCallback> progress);
 	static bool                  IsArchive(const QString& filename);
 	static QStringList           GetTypes();
+	static void                  DropIdle(const QString& filename);
 };
 
 }
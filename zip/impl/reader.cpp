@@ -1,7 +1,13 @@
 #include "reader.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <QBuffer>
 
+#include "fnd/QIODeviceStreamWrapper.h"
 #include "fnd/ScopedCall.h"
 
 #include "bit7z/bitinputarchive.hpp"
@@ -18,12 +24,26 @@ namespace HomeCompa::ZipDetails::SevenZip
 namespace
 {
 
+constexpr size_t STREAMING_THRESHOLD = 8 * 1024 * 1024; // the smaller entries are extracted at once with the Zip reader and can be read again
+constexpr size_t RING_BUFFER_SIZE    = 1024 * 1024;
+
+ScopedCall LockExtraction(std::atomic_flag& busy)
+{
+	if (busy.test_and_set())
+		throw std::runtime_error("Previous archive entry is still being read");
+
+	return ScopedCall([&busy] {
+		busy.clear();
+	});
+}
+
 class StreamImpl final : public Stream
 {
 public:
-	StreamImpl(const bit7z::BitInputArchive& zip, const FileItem& fileItem)
+	StreamImpl(const bit7z::BitInputArchive& zip, const FileItem& fileItem, std::atomic_flag& busy)
 		: m_outStream(&m_bytes)
 	{
+		const auto       extractionGuard = LockExtraction(busy);
 		const ScopedCall ioDeviceGuard(
 			[this] {
 				m_outStream.open(QIODevice::WriteOnly);
@@ -32,9 +52,9 @@ public:
 				m_outStream.close();
 			}
 		);
-		std::vector<std::byte> buffer;
-		zip.extractTo(buffer, fileItem.index);
-		m_bytes = QByteArray { reinterpret_cast<char*>(buffer.data()), static_cast<qsizetype_t>(buffer.size()) };
+		m_bytes.reserve(static_cast<qsizetype_t>(fileItem.size));
+		const auto stream = QStdOStream::create(m_outStream);
+		zip.extractTo(*stream, fileItem.index);
 	}
 
 private: // Stream
@@ -51,12 +71,215 @@ private:
 	std::unique_ptr<QBuffer> m_buffer;
 };
 
+/// sequential device over a bounded ring buffer: the extraction thread pushes, the reader blocks until the bytes come
+class RingBufferDevice final : public QIODevice
+{
+public:
+	RingBufferDevice()
+	{
+		m_ring.resize(RING_BUFFER_SIZE);
+		open(QIODevice::ReadOnly);
+	}
+
+public:
+	/// false if the reader is gone
+	bool Push(const char* data, size_t size)
+	{
+		std::unique_lock lock(m_guard);
+		while (size)
+		{
+			m_condition.wait(lock, [this] {
+				return m_canceled || m_size < m_ring.size();
+			});
+			if (m_canceled)
+				return false;
+
+			const auto tail  = (m_head + m_size) % m_ring.size();
+			const auto count = std::min({ size, m_ring.size() - m_size, m_ring.size() - tail });
+			std::copy_n(data, count, m_ring.data() + tail);
+			m_size += count;
+			data   += count;
+			size   -= count;
+			m_condition.notify_all();
+		}
+		return true;
+	}
+
+	void Close(QString error)
+	{
+		std::scoped_lock lock(m_guard);
+		m_closed = true;
+		m_error  = std::move(error);
+		m_condition.notify_all();
+	}
+
+	bool IsCanceled() const
+	{
+		std::scoped_lock lock(m_guard);
+		return m_canceled;
+	}
+
+	void Cancel()
+	{
+		std::scoped_lock lock(m_guard);
+		m_canceled = true;
+		m_condition.notify_all();
+	}
+
+private: // QIODevice
+	bool isSequential() const override
+	{
+		return true;
+	}
+
+	bool atEnd() const override
+	{
+		{
+			std::scoped_lock lock(m_guard);
+			if (!m_closed || m_size > 0)
+				return false;
+		}
+		return QIODevice::atEnd();
+	}
+
+	qint64 bytesAvailable() const override
+	{
+		std::scoped_lock lock(m_guard);
+		return static_cast<qint64>(m_size) + QIODevice::bytesAvailable();
+	}
+
+	qint64 readData(char* data, const qint64 maxSize) override
+	{
+		std::unique_lock lock(m_guard);
+		m_condition.wait(lock, [this] {
+			return m_closed || m_size > 0;
+		});
+
+		if (m_size == 0)
+		{
+			if (m_error.isEmpty())
+				return 0;
+
+			setErrorString(m_error);
+			return -1;
+		}
+
+		const auto count = std::min({ static_cast<size_t>(maxSize), m_size, m_ring.size() - m_head });
+		std::copy_n(m_ring.data() + m_head, count, data);
+		m_head  = (m_head + count) % m_ring.size();
+		m_size -= count;
+		m_condition.notify_all();
+
+		return static_cast<qint64>(count);
+	}
+
+	qint64 writeData(const char* /*data*/, qint64 /*maxSize*/) override
+	{
+		return -1;
+	}
+
+private:
+	mutable std::mutex      m_guard;
+	std::condition_variable m_condition;
+	std::vector<char>       m_ring;
+	size_t                  m_head { 0 };
+	size_t                  m_size { 0 };
+	bool                    m_closed { false };
+	bool                    m_canceled { false };
+	QString                 m_error;
+};
+
+class RingBufferStreamBuf final : public std::streambuf
+{
+public:
+	explicit RingBufferStreamBuf(RingBufferDevice& device)
+		: m_device { device }
+	{
+	}
+
+private: // std::streambuf
+	std::streamsize xsputn(const char_type* str, const std::streamsize n) override
+	{
+		return m_device.Push(str, static_cast<size_t>(n)) ? n : 0;
+	}
+
+	int_type overflow(const int_type ch) override
+	{
+		if (traits_type::eq_int_type(ch, traits_type::eof()))
+			return traits_type::not_eof(ch);
+
+		const auto c = traits_type::to_char_type(ch);
+		return m_device.Push(&c, 1) ? ch : traits_type::eof();
+	}
+
+private:
+	RingBufferDevice& m_device;
+};
+
+/// the entry is extracted on a separate thread while it is read, the memory used does not depend on the entry size;
+/// the stream owns its archive reader and the entry description, it does not depend on the Zip it is read from
+class StreamingStreamImpl final : public Stream
+{
+public:
+	StreamingStreamImpl(std::shared_ptr<const bit7z::BitInputArchive> archive, FileItem fileItem)
+		: m_archive { std::move(archive) }
+		, m_fileItem { std::move(fileItem) }
+		, m_thread(&StreamingStreamImpl::Extract, this)
+	{
+	}
+
+	~StreamingStreamImpl() override
+	{
+		m_device.Cancel();
+		m_thread.join();
+	}
+
+private: // Stream
+	QIODevice& GetStream() override
+	{
+		return m_device;
+	}
+
+private:
+	void Extract()
+	{
+		QString error;
+		try
+		{
+			RingBufferStreamBuf streamBuf(m_device);
+			std::ostream        stream(&streamBuf);
+			m_archive->extractTo(stream, m_fileItem.index);
+		}
+		catch (const std::exception& ex)
+		{
+			error = QString::fromStdString(ex.what());
+		}
+		catch (...)
+		{
+			error = "unknown error";
+		}
+
+		if (!error.isEmpty() && !m_device.IsCanceled())
+			PLOGE << m_fileItem.name << " read error: " << error;
+
+		m_device.Close(std::move(error));
+	}
+
+private:
+	const std::shared_ptr<const bit7z::BitInputArchive> m_archive;
+	const FileItem                                      m_fileItem;
+	RingBufferDevice                                    m_device;
+	std::thread                                         m_thread;
+};
+
 class FileReader final : virtual public IFile
 {
 public:
-	FileReader(const bit7z::BitInputArchive& zip, const FileItem& fileItem)
+	FileReader(const bit7z::BitInputArchive& zip, const FileItem& fileItem, std::atomic_flag& busy, File::ArchiveOpener openArchive)
 		: m_zip { zip }
 		, m_fileItem { fileItem }
+		, m_busy { busy }
+		, m_openArchive { std::move(openArchive) }
 	{
 	}
 
@@ -65,7 +288,10 @@ private: // IFile
 	{
 		try
 		{
-			return std::make_unique<StreamImpl>(m_zip, m_fileItem);
+			if (m_fileItem.size > STREAMING_THRESHOLD)
+				return std::make_unique<StreamingStreamImpl>(m_openArchive(), m_fileItem);
+
+			return std::make_unique<StreamImpl>(m_zip, m_fileItem, m_busy);
 		}
 		catch (const std::exception& ex)
 		{
@@ -87,6 +313,8 @@ private: // IFile
 private:
 	const bit7z::BitInputArchive& m_zip;
 	const FileItem&               m_fileItem;
+	std::atomic_flag&             m_busy;
+	const File::ArchiveOpener     m_openArchive;
 };
 
 } // namespace
@@ -94,9 +322,9 @@ private:
 namespace File
 {
 
-std::unique_ptr<IFile> Read(const bit7z::BitInputArchive& zip, const FileItem& fileItem)
+std::unique_ptr<IFile> Read(const bit7z::BitInputArchive& zip, const FileItem& fileItem, std::atomic_flag& busy, ArchiveOpener openArchive)
 {
-	return std::make_unique<FileReader>(zip, fileItem);
+	return std::make_unique<FileReader>(zip, fileItem, busy, std::move(openArchive));
 }
 
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
 
 namespace bit7z
@@ -24,7 +26,12 @@ struct FileItem;
 namespace File
 {
 
-std::unique_ptr<IFile> Read(const bit7z::BitInputArchive& zip, const FileItem& fileItem);
+/// another reader of the archive that does not depend on the Zip
+using ArchiveOpener = std::function<std::shared_ptr<const bit7z::BitInputArchive>()>;
+
+/// busy is set while an entry is extracted, the archive cannot extract two entries at once;
+/// a large entry is streamed by its own reader got from openArchive, the stream may outlive the Zip
+std::unique_ptr<IFile> Read(const bit7z::BitInputArchive& zip, const FileItem& fileItem, std::atomic_flag& busy, ArchiveOpener openArchive);
 
 };
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <memory>
 
 #include <QStringList>
@@ -20,6 +21,8 @@ namespace HomeCompa::ZipDetails
 
 class IFile;
 
+using ExtractCallback = std::function<void(const QString& fileName, QByteArray body)>;
+
 class IZip // NOLINT(cppcoreguidelines-special-member-functions)
 {
 public:
@@ -32,6 +35,8 @@ public:
 	[[nodiscard]] virtual std::unique_ptr<IFile>                  Read(const QString& filename) const = 0;
 	[[nodiscard]] virtual std::unordered_map<QString, QByteArray> ReadAll() const                     = 0;
 
+	virtual void Extract(const QStringList& fileNames, const ExtractCallback& callback, unsigned threadCount) const = 0;
+
 	virtual void SetProperty(PropertyId id, QVariant value)     = 0;
 	virtual bool Write(const IZipFileProvider& zipFileProvider) = 0;
 
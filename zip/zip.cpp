@@ -206,6 +206,11 @@ public:
 		return m_zip->ReadAll();
 	}
 
+	void Extract(const QStringList& fileNames, const ExtractCallback& callback, const unsigned threadCount) const
+	{
+		m_zip->Extract(fileNames, callback, threadCount);
+	}
+
 	bool Write(const IZipFileProvider& zipFileProvider)
 	{
 		return m_zip->Write(zipFileProvider);
@@ -246,6 +251,11 @@ QStringList Zip::GetTypes()
 	return SevenZip::Archive::GetTypes();
 }
 
+void Zip::DropIdle(const QString& filename)
+{
+	SevenZip::Archive::DropIdle(filename);
+}
+
 Zip::Zip(const QString& filename, std::shared_ptr<ProgressCallback> progress)
 	: m_impl(std::make_unique<Impl>(filename, std::move(progress)))
 {
@@ -283,6 +293,11 @@ std::unordered_map<QString, QByteArray> Zip::ReadAll() const
 	return m_impl->ReadAll();
 }
 
+void Zip::Extract(const QStringList& fileNames, const ExtractCallback& callback, const unsigned threadCount) const
+{
+	m_impl->Extract(fileNames, callback, threadCount);
+}
+
 QStringList Zip::GetFileNameList() const
 {
 	return m_impl->GetFileNameList();
@@ -26,6 +26,7 @@ public:
 	using PropertyId        = ZipDetails::PropertyId;
 	using CompressionLevel  = ZipDetails::CompressionLevel;
 	using CompressionMethod = ZipDetails::CompressionMethod;
+	using ExtractCallback   = ZipDetails::ExtractCallback;
 
 	static constexpr auto INVALID_INDEX = ZipDetails::INVALID_INDEX;
 
@@ -38,6 +39,10 @@ public:
 	static bool        IsArchive(const QString& filename);
 	static QStringList GetTypes();
 
+	/// the readers share their open archives, an idle one keeps its file open for up to 30 seconds;
+	/// drops the idle archives of the file, or all of them for an empty filename, before the file is renamed or deleted
+	static void DropIdle(const QString& filename = {});
+
 public:
 	explicit Zip(const QString& filename, std::shared_ptr<ProgressCallback> progress = {});
 	explicit Zip(QIODevice& stream, std::shared_ptr<ProgressCallback> progress = {});
@@ -50,9 +55,18 @@ public:
 	[[nodiscard]] const QDateTime& GetFileTime(const QString& filename) const;
 	[[nodiscard]] size_t           GetFileIndex(const QString& filename) const;
 
-	[[nodiscard]] std::unique_ptr<Stream>                 Read(const QString& filename) const;
+	/// the stream may outlive the Zip; an entry over 8 MB is not kept in memory but extracted while it is read by its own archive reader,
+	/// the stream is sequential then and the progress callback does not get its extraction
+	[[nodiscard]] std::unique_ptr<Stream> Read(const QString& filename) const;
+
+	/// on the calling thread, Extract opts into the parallel read
 	[[nodiscard]] std::unordered_map<QString, QByteArray> ReadAll() const;
 
+	/// batched read: the entries are grouped by solid block, a block is decoded once per batch of up to 256 MB extracted through a temporary folder,
+	/// the groups are extracted in parallel, each thread with its own reader; the callback gets the entries as they are ready, one call at a time,
+	/// threadCount 0 means all the cores
+	void Extract(const QStringList& fileNames, const ExtractCallback& callback, unsigned threadCount = 0) const;
+
 	void SetProperty(PropertyId id, QVariant value);
 	bool Write(const IZipFileProvider& zipFileProvider);
 